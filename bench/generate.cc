@@ -0,0 +1,29 @@
+// Writes synthetic tab-separated data to the standard output.
+//
+//   ./generate <shape> <rows>
+//
+// Shape is one of narrow, wide, strings and dirty.
+
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+#include "generate.hpp"
+
+
+int main(int argc, char** argv)
+{
+    if (argc != 3) {
+        std::cerr << "usage: generate <narrow|wide|strings|dirty> <rows>\n";
+        return 1;
+    }
+
+    try {
+        auto const rows = static_cast<std::size_t>(std::stoull(argv[2]));
+        std::cout << bench::generate(argv[1], rows);
+    } catch (std::exception const& err) {
+        std::cerr << "error: " << err.what() << '\n';
+        return 1;
+    }
+}
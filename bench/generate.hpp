@@ -0,0 +1,187 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+
+// Generators of synthetic tab-separated data. Texts are deterministic for
+// a given number of rows, so results are comparable across runs.
+
+namespace bench
+{
+    // Shapes of the generated data.
+    inline constexpr std::string_view shapes[] = {
+        "narrow", "wide", "strings", "dirty"
+    };
+
+    // Number of columns in the wide shape.
+    inline constexpr std::size_t wide_columns = 300;
+
+    // Small and fast pseudo-random number generator (xorshift64*).
+    class random
+    {
+    public:
+        explicit random(std::uint64_t seed)
+            : _state{seed | 1}
+        {
+        }
+
+        std::uint64_t next()
+        {
+            _state ^= _state >> 12;
+            _state ^= _state << 25;
+            _state ^= _state >> 27;
+            return _state * 2685821657736338717u;
+        }
+
+        // Returns an integer in [0, n).
+        std::uint64_t below(std::uint64_t n)
+        {
+            return next() % n;
+        }
+
+    private:
+        std::uint64_t _state;
+    };
+
+    inline
+    void append_double(std::string& text, random& rng)
+    {
+        text += std::to_string(rng.below(100000));
+        text += '.';
+        text += std::to_string(rng.below(1000000));
+    }
+
+    inline
+    void append_word(std::string& text, random& rng, std::size_t max_length)
+    {
+        auto const length = 1 + rng.below(max_length);
+        for (std::size_t i = 0; i < length; i++) {
+            text += static_cast<char>('a' + rng.below(26));
+        }
+    }
+
+    // Narrow numeric rows: id, count, value, ratio.
+    inline
+    void append_narrow_row(std::string& text, random& rng, std::size_t row)
+    {
+        text += std::to_string(row);
+        text += '\t';
+        text += std::to_string(rng.below(1000000));
+        text += '\t';
+        append_double(text, rng);
+        text += '\t';
+        text += '0';
+        text += '.';
+        text += std::to_string(rng.below(1000));
+        text += '\n';
+    }
+
+    inline
+    std::string generate_narrow(std::size_t rows)
+    {
+        random rng{1};
+        std::string text = "id\tcount\tvalue\tratio\n";
+        for (std::size_t row = 0; row < rows; row++) {
+            append_narrow_row(text, rng, row);
+        }
+        return text;
+    }
+
+    // Wide rows of small integers.
+    inline
+    std::string generate_wide(std::size_t rows)
+    {
+        random rng{2};
+        std::string text;
+        for (std::size_t col = 0; col < wide_columns; col++) {
+            text += col ? "\tc" : "c";
+            text += std::to_string(col);
+        }
+        text += '\n';
+
+        for (std::size_t row = 0; row < rows; row++) {
+            for (std::size_t col = 0; col < wide_columns; col++) {
+                if (col) {
+                    text += '\t';
+                }
+                text += std::to_string(rng.below(10000));
+            }
+            text += '\n';
+        }
+        return text;
+    }
+
+    // String-heavy rows: id, code, name, category, description.
+    inline
+    std::string generate_strings(std::size_t rows)
+    {
+        random rng{3};
+        std::string text = "id\tcode\tname\tcategory\tdescription\n";
+        for (std::size_t row = 0; row < rows; row++) {
+            text += std::to_string(row);
+            text += '\t';
+            text += static_cast<char>('A' + rng.below(26));
+            text += '\t';
+            append_word(text, rng, 16);
+            text += '\t';
+            text += "category";
+            text += std::to_string(rng.below(20));
+            text += '\t';
+            for (auto words = 1 + rng.below(12); words > 0; words--) {
+                append_word(text, rng, 10);
+                text += ' ';
+            }
+            text += '\n';
+        }
+        return text;
+    }
+
+    // Narrow numeric rows mixed with comments, empty lines and about 1% of
+    // malformed rows.
+    inline
+    std::string generate_dirty(std::size_t rows)
+    {
+        random rng{4};
+        std::string text = "# generated\nid\tcount\tvalue\tratio\n";
+        for (std::size_t row = 0; row < rows; row++) {
+            switch (rng.below(100)) {
+            case 0:
+                text += "# comment\n";
+                break;
+            case 1:
+                text += '\n';
+                break;
+            case 2:
+                text += "n/a\t1\t2.0\n";
+                continue;
+            default:
+                break;
+            }
+            append_narrow_row(text, rng, row);
+        }
+        return text;
+    }
+
+    // Generates a text of the named shape.
+    inline
+    std::string generate(std::string_view shape, std::size_t rows)
+    {
+        if (shape == "narrow") {
+            return generate_narrow(rows);
+        }
+        if (shape == "wide") {
+            return generate_wide(rows);
+        }
+        if (shape == "strings") {
+            return generate_strings(rows);
+        }
+        if (shape == "dirty") {
+            return generate_dirty(rows);
+        }
+        throw std::invalid_argument{"unknown shape: " + std::string{shape}};
+    }
+}
@@ -0,0 +1,337 @@
+// Throughput benchmarks of the parser.
+//
+//   ./main [scale]
+//
+// Results are printed as tab-separated rows with a header, so that they can
+// be tracked across releases. `scale` multiplies the sizes of the inputs.
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <tsv.hpp>
+
+#include "generate.hpp"
+
+
+namespace
+{
+    // Results are accumulated here so that the compiler does not elide the
+    // benchmarked code.
+    volatile std::uint64_t sink;
+
+    // Stream buffer reading from a string without copying it.
+    class memory_buffer : public std::streambuf
+    {
+    public:
+        explicit memory_buffer(std::string_view text)
+        {
+            auto const data = const_cast<char*>(text.data());
+            setg(data, data, data + text.size());
+        }
+    };
+
+    // Runs a benchmark at least three times and for at least a fraction of
+    // a second, and prints the best throughput.
+    template<typename Run>
+    void measure(
+        std::string_view name,
+        std::string_view subject,
+        std::size_t bytes,
+        std::size_t rows,
+        Run run
+    )
+    {
+        using clock = std::chrono::steady_clock;
+
+        constexpr double min_total = 0.5;
+        constexpr int min_runs = 3;
+
+        double best = 0;
+        double total = 0;
+
+        for (int runs = 0; runs < min_runs || total < min_total; runs++) {
+            auto const start = clock::now();
+            run();
+            std::chrono::duration<double> const elapsed = clock::now() - start;
+
+            if (runs == 0 || elapsed.count() < best) {
+                best = elapsed.count();
+            }
+            total += elapsed.count();
+        }
+
+        std::cout
+            << name << '\t'
+            << subject << '\t'
+            << bytes << '\t'
+            << rows << '\t'
+            << best << '\t'
+            << static_cast<double>(bytes) / best / 1e6 << '\t'
+            << static_cast<double>(rows) / best << '\n';
+    }
+
+    // Counts the data lines in a text, which is the number of rows reported
+    // for the line-level benchmarks.
+    std::size_t count_lines(std::string_view text)
+    {
+        return static_cast<std::size_t>(std::count(text.begin(), text.end(), '\n'));
+    }
+
+    void bench_line_reader(std::string_view shape, std::string_view text)
+    {
+        measure("line_reader", shape, text.size(), count_lines(text), [&] {
+            memory_buffer buffer{text};
+            std::istream stream{&buffer};
+            tsv::detail::line_reader reader{stream};
+
+            std::uint64_t total = 0;
+            while (auto const line = reader.consume()) {
+                total += line->size();
+            }
+            sink = total;
+        });
+    }
+
+    void bench_split_consume(std::string_view shape, std::string_view text)
+    {
+        measure("split_consume", shape, text.size(), count_lines(text), [&] {
+            std::uint64_t fields = 0;
+            auto rest = text;
+            while (!rest.empty()) {
+                auto line = tsv::detail::split_consume(rest, '\n');
+                for (;;) {
+                    auto const field = tsv::detail::split_consume(line, '\t');
+                    fields += field.size() + 1;
+                    if (line.empty()) {
+                        break;
+                    }
+                }
+            }
+            sink = fields;
+        });
+    }
+
+    template<typename Record>
+    void bench_load(
+        std::string_view shape,
+        std::string_view text,
+        tsv::options const& opts = {}
+    )
+    {
+        std::size_t rows = 0;
+        {
+            memory_buffer buffer{text};
+            std::istream stream{&buffer};
+            rows = tsv::load<Record>(stream, opts).size();
+        }
+
+        measure("load", shape, text.size(), rows, [&] {
+            memory_buffer buffer{text};
+            std::istream stream{&buffer};
+            sink = tsv::load<Record>(stream, opts).size();
+        });
+    }
+
+    void bench_load_table(
+        std::string_view shape,
+        std::string_view text,
+        std::vector<tsv::column_spec> const& schema
+    )
+    {
+        std::size_t rows = 0;
+        {
+            memory_buffer buffer{text};
+            std::istream stream{&buffer};
+            rows = tsv::load_table(stream, schema).size();
+        }
+
+        measure("load_table", shape, text.size(), rows, [&] {
+            memory_buffer buffer{text};
+            std::istream stream{&buffer};
+            sink = tsv::load_table(stream, schema).size();
+        });
+    }
+
+    // Folds a parsed value into a checksum.
+    template<typename T>
+    std::uint64_t checksum(T const& value)
+    {
+        if constexpr (std::is_arithmetic_v<T>) {
+            return static_cast<std::uint64_t>(value);
+        } else {
+            return value.size();
+        }
+    }
+
+    // Parses every field text with a default conversion.
+    template<typename T>
+    void bench_conversion(std::string_view type_name, std::vector<std::string> const& texts)
+    {
+        std::size_t bytes = 0;
+        for (auto const& text : texts) {
+            bytes += text.size();
+        }
+
+        measure("default_conversion", type_name, bytes, texts.size(), [&] {
+            std::uint64_t total = 0;
+            for (auto const& text : texts) {
+                T value{};
+                if (!tsv::detail::default_conversion<T>::try_parse(text, value)) {
+                    total += checksum(value);
+                }
+            }
+            sink = total;
+        });
+    }
+
+    std::vector<std::string> make_texts(
+        std::size_t count, std::string (*make)(bench::random&)
+    )
+    {
+        bench::random rng{5};
+        std::vector<std::string> texts;
+        texts.reserve(count);
+        for (std::size_t i = 0; i < count; i++) {
+            texts.push_back(make(rng));
+        }
+        return texts;
+    }
+
+    struct narrow_record
+    {
+        int id;
+        unsigned count;
+        double value;
+        float ratio;
+    };
+
+    // Eight of the columns in the wide shape, selected by projection.
+    struct wide_record
+    {
+        int c0;
+        int c37;
+        int c74;
+        int c111;
+        int c148;
+        int c185;
+        int c222;
+        int c299;
+    };
+
+    struct strings_record
+    {
+        int id;
+        char code;
+        std::string name;
+        std::string category;
+        std::string description;
+    };
+}
+
+int main(int argc, char** argv)
+{
+    std::size_t scale = 1;
+    if (argc > 1) {
+        scale = std::max<std::size_t>(1, std::strtoul(argv[1], nullptr, 10));
+    }
+
+    auto const narrow = bench::generate("narrow", 1000000 * scale);
+    auto const wide = bench::generate("wide", 20000 * scale);
+    auto const strings = bench::generate("strings", 300000 * scale);
+    auto const dirty = bench::generate("dirty", 1000000 * scale);
+
+    std::pair<std::string_view, std::string_view> const inputs[] = {
+        {"narrow", narrow},
+        {"wide", wide},
+        {"strings", strings},
+        {"dirty", dirty},
+    };
+
+    std::cout << "benchmark\tsubject\tbytes\trows\tseconds\tmb_per_s\trows_per_s\n";
+
+    for (auto const& [shape, text] : inputs) {
+        bench_line_reader(shape, text);
+    }
+
+    for (auto const& [shape, text] : inputs) {
+        bench_split_consume(shape, text);
+    }
+
+    bench_load<narrow_record>("narrow", narrow);
+    {
+        tsv::options opts;
+        opts.columns = {0, 37, 74, 111, 148, 185, 222, 299};
+        bench_load<wide_record>("wide", wide, opts);
+    }
+    bench_load<strings_record>("strings", strings);
+    {
+        tsv::options opts;
+        opts.comment = '#';
+        opts.on_error = tsv::error_policy::skip;
+        bench_load<narrow_record>("dirty", dirty, opts);
+    }
+
+    bench_load_table("narrow", narrow, {
+        {"id", tsv::column_type::int64},
+        {"count", tsv::column_type::int64},
+        {"value", tsv::column_type::float64},
+        {"ratio", tsv::column_type::float64},
+    });
+    bench_load_table("strings", strings, {
+        {"id", tsv::column_type::int64},
+        {"code", tsv::column_type::string},
+        {"name", tsv::column_type::string},
+        {"category", tsv::column_type::string},
+        {"description", tsv::column_type::string},
+    });
+
+    // Field texts for the conversion benchmarks.
+    auto const count = 1000000 * scale;
+
+    auto const integers = make_texts(count, [](bench::random& rng) {
+        return std::to_string(static_cast<std::int64_t>(rng.below(2000000000)) - 1000000000);
+    });
+    auto const unsigned_integers = make_texts(count, [](bench::random& rng) {
+        return std::to_string(rng.below(4000000000));
+    });
+    auto const long_integers = make_texts(count, [](bench::random& rng) {
+        return std::to_string(static_cast<std::int64_t>(rng.next() >> 1));
+    });
+    auto const decimals = make_texts(count, [](bench::random& rng) {
+        std::string text;
+        bench::append_double(text, rng);
+        return text;
+    });
+    auto const characters = make_texts(count, [](bench::random& rng) {
+        return std::string(1, static_cast<char>('a' + rng.below(26)));
+    });
+    auto const words = make_texts(count, [](bench::random& rng) {
+        std::string text;
+        bench::append_word(text, rng, 16);
+        return text;
+    });
+    auto const booleans = make_texts(count, [](bench::random& rng) {
+        return std::string(1, rng.below(2) ? '1' : '0');
+    });
+
+    bench_conversion<int>("int", integers);
+    bench_conversion<unsigned>("unsigned", unsigned_integers);
+    bench_conversion<std::int64_t>("int64", long_integers);
+    bench_conversion<float>("float", decimals);
+    bench_conversion<double>("double", decimals);
+    bench_conversion<long double>("long_double", decimals);
+    bench_conversion<char>("char", characters);
+    bench_conversion<std::string>("string", words);
+    bench_conversion<std::string_view>("string_view", words);
+    bench_conversion<bool>("bool_stream", booleans);
+}
@@ -26,34 +26,326 @@
 #ifndef INCLUDED_SNSINFU_TSV_HPP
 #define INCLUDED_SNSINFU_TSV_HPP
 
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
 #include <charconv>
+#include <chrono>
+#include <condition_variable>
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <functional>
 #include <istream>
+#include <iterator>
+#include <limits>
+#include <locale>
+#include <memory>
+#include <mutex>
 #include <optional>
 #include <sstream>
 #include <stdexcept>
 #include <string>
 #include <string_view>
+#include <system_error>
+#include <thread>
+#include <tuple>
 #include <type_traits>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
+#if !defined(TSV_USE_MMAP)
+#  if defined(__unix__) || defined(__APPLE__)
+#    define TSV_USE_MMAP 1
+#  else
+#    define TSV_USE_MMAP 0
+#  endif
+#endif
+
+#if !defined(TSV_NO_SIMD)
+#  if defined(__AVX2__)
+#    include <immintrin.h>
+#    define TSV_SIMD_AVX2 1
+#  elif defined(__SSE2__) || defined(_M_X64)
+#    include <emmintrin.h>
+#    define TSV_SIMD_SSE2 1
+#  elif defined(__ARM_NEON) && defined(__aarch64__)
+#    include <arm_neon.h>
+#    define TSV_SIMD_NEON 1
+#  endif
+#endif
+
+#if defined(TSV_SIMD_AVX2) || defined(TSV_SIMD_SSE2) || defined(TSV_SIMD_NEON)
+#  define TSV_SIMD 1
+#else
+#  define TSV_SIMD 0
+#endif
+
+#if defined(_MSC_VER)
+#  include <intrin.h>
+#endif
+
+#if !defined(TSV_ENABLE_ZLIB)
+#  define TSV_ENABLE_ZLIB 0
+#endif
+
+#if !defined(TSV_ENABLE_ZSTD)
+#  define TSV_ENABLE_ZSTD 0
+#endif
+
+#if !defined(TSV_ENABLE_TIMING)
+#  define TSV_ENABLE_TIMING 0
+#endif
+
+#if TSV_ENABLE_ZLIB
+#  include <zlib.h>
+#endif
+
+#if TSV_ENABLE_ZSTD
+#  include <zstd.h>
+#endif
+
+#if TSV_USE_MMAP
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
 
 namespace tsv
 {
+    class dictionary;
+    class error;
+
+    /** Specifies how rows that fail to parse or validate are handled. */
+    enum class error_policy
+    {
+        /** Throw the error. Loading stops at the first bad row. */
+        raise,
+
+        /** Skip bad rows. The reader counts the skipped rows. */
+        skip,
+
+        /** Skip bad rows and save their errors to `options::rejected`. */
+        collect,
+    };
+
+    /**
+     * Counters of the work done by a loader. Loaders add to the counters, so
+     * one object can accumulate the statistics of multiple inputs.
+     */
+    struct load_stats
+    {
+        /** Number of bytes in the lines consumed, including newlines. */
+        std::uint64_t bytes = 0;
+
+        /** Number of lines consumed, including the header and comments. */
+        std::uint64_t lines = 0;
+
+        /** Number of comment and empty lines skipped. */
+        std::uint64_t skipped_lines = 0;
+
+        /** Number of rows loaded. */
+        std::uint64_t rows = 0;
+
+        /** Number of rows rejected under the skip or collect error policy. */
+        std::uint64_t rejected_rows = 0;
+
+        /** Number of rows dropped by the filters without being parsed. */
+        std::uint64_t filtered_rows = 0;
+
+        /**
+         * Time spent in reading lines from the input, parsing the fields of
+         * rows and validating records. These are measured only if the library
+         * is compiled with TSV_ENABLE_TIMING defined to 1, since reading the
+         * clock costs more than parsing a short row.
+         */
+        std::chrono::nanoseconds read_time{};
+        std::chrono::nanoseconds parse_time{};
+        std::chrono::nanoseconds validate_time{};
+
+        load_stats& operator+=(load_stats const& other)
+        {
+            bytes += other.bytes;
+            lines += other.lines;
+            skipped_lines += other.skipped_lines;
+            rows += other.rows;
+            rejected_rows += other.rejected_rows;
+            filtered_rows += other.filtered_rows;
+            read_time += other.read_time;
+            parse_time += other.parse_time;
+            validate_time += other.validate_time;
+            return *this;
+        }
+    };
+
+    /** Specifies how special characters in fields are encoded. */
+    enum class escaping
+    {
+        /** Fields are taken as is and cannot contain delimiters or newlines. */
+        none,
+
+        /**
+         * Backslash sequences as in the text format of PostgreSQL COPY: `\t`,
+         * `\n`, `\r`, `\b`, `\f`, `\v` and `\\`. A backslash followed by
+         * any other character, including the delimiter, stands for that
+         * character. Lines are still split at every raw newline.
+         */
+        backslash,
+    };
+
+    /**
+     * Predicate on the raw text of an input column. Rows whose text does not
+     * satisfy the predicate are dropped before any field is parsed. See
+     * `tsv::equals` and `tsv::starts_with` for common predicates.
+     */
+    struct filter
+    {
+        /** Zero-based index of the input column tested. */
+        std::size_t column = 0;
+
+        /** Returns true if a row having the text in the column is loaded. */
+        std::function<bool(std::string_view)> accept;
+    };
+
     /** Holds options to control how a TSV input is handled. */
     struct options
     {
         /** A character used to split fields. */
         char delimiter = '\t';
 
-        /** True to skip the first non-comment line. */
+        /**
+         * True to skip the first non-comment line. `tsv::writer` writes a
+         * header line only if `column_names` is also set.
+         */
         bool header = true;
 
         /** Lines starting with this character are skipped. */
         char comment = 0;
+
+        /**
+         * How special characters in fields are encoded. With escapes, only
+         * the fields that contain a backslash are unescaped into a buffer;
+         * the other fields are parsed in place as usual.
+         */
+        tsv::escaping escaping = tsv::escaping::none;
+
+        /**
+         * Zero-based indices of the input columns assigned to the fields of a
+         * record, in the order of the fields. Columns not listed here are
+         * skipped without being parsed. Empty means that the columns are
+         * assigned to the fields in order.
+         */
+        std::vector<std::size_t> columns;
+
+        /**
+         * Names of the header columns assigned to the fields of a record, in
+         * the order of the fields. The names are looked up in the header line
+         * once, so the column order of an input does not matter. This option
+         * requires `header` and cannot be used together with `columns`.
+         */
+        std::vector<std::string> column_names;
+
+        /**
+         * Dictionary receiving the texts of `tsv::interned` fields. This must
+         * be set if a record has interned fields. The dictionary must outlive
+         * the loader.
+         */
+        tsv::dictionary* dictionary = nullptr;
+
+        /**
+         * How rows that fail to parse or validate are handled. Under the skip
+         * and collect policies, bad rows are detected without throwing an
+         * exception unless a custom conversion or validation throws one.
+         */
+        tsv::error_policy on_error = tsv::error_policy::raise;
+
+        /**
+         * True to read stream inputs ahead of parsing on a background thread,
+         * so that parsing overlaps with slow inputs like pipes. The reader
+         * consumes the stream beyond the last line parsed. This option has
+         * no effect on file inputs.
+         */
+        bool read_ahead = false;
+
+        /**
+         * Vector receiving the errors of the rows rejected under the collect
+         * policy, in the input order. This must be set if `on_error` is
+         * collect. The vector must outlive the loader.
+         */
+        std::vector<tsv::error>* rejected = nullptr;
+
+        /**
+         * Path of a binary cache of the records loaded by `tsv::load_file`.
+         * If set, the records are read from the cache when it matches the
+         * size and modification time of the file, the record layout and the
+         * options. Otherwise the file is parsed and the cache is rewritten.
+         * The cache is not used with the collect policy or filters. Empty
+         * means no cache. Invalid booleans in a corrupt cache are detected,
+         * but fields of class types are trusted as saved.
+         */
+        std::filesystem::path cache;
+
+        /**
+         * Statistics receiving the counts of lines, bytes and rows processed.
+         * Null means no statistics. The object must outlive the loader.
+         */
+        tsv::load_stats* stats = nullptr;
+
+        /**
+         * Function called with the statistics every `progress_interval` rows
+         * and at the end of an input. Parallel loaders call it after each
+         * chunk, from one worker thread at a time. This requires `stats`.
+         */
+        std::function<void(tsv::load_stats const&)> progress;
+
+        /** Number of rows between calls of the progress function. */
+        std::size_t progress_interval = std::size_t(1) << 16;
+
+        /**
+         * Filters on the raw texts of input columns. A row is loaded only if
+         * it satisfies all the filters. Other rows are skipped after scanning
+         * the delimiters up to the tested columns. A row too short to test
+         * is passed to the parser, which applies the error policy. With
+         * backslash escaping, the fields are split at unescaped delimiters
+         * and filters see the unescaped texts.
+         */
+        std::vector<tsv::filter> filters;
     };
 
+    /** Makes a filter that accepts rows having a text in a column. */
+    inline
+    tsv::filter equals(std::size_t column, std::string text)
+    {
+        return {column, [text = std::move(text)](std::string_view field) {
+            return field == text;
+        }};
+    }
+
+    /** Makes a filter that accepts rows having any of texts in a column. */
+    inline
+    tsv::filter one_of(std::size_t column, std::vector<std::string> texts)
+    {
+        return {column, [texts = std::move(texts)](std::string_view field) {
+            return std::find(texts.begin(), texts.end(), field) != texts.end();
+        }};
+    }
+
+    /** Makes a filter that accepts rows whose text in a column has a prefix. */
+    inline
+    tsv::filter starts_with(std::size_t column, std::string prefix)
+    {
+        return {column, [prefix = std::move(prefix)](std::string_view field) {
+            return field.substr(0, prefix.size()) == prefix;
+        }};
+    }
+
     /**
      * Loads tab-separated values from each line of an input.
      *
@@ -72,9 +364,31 @@ namespace tsv
     }
 
     /**
-     * Traits class for customizing how values of type T are parsed. Default
-     * implementations for string, char and numeric types are defined in this
-     * library.
+     * Loads tab-separated values from each line of a file. The file is
+     * memory-mapped if possible, which is faster than loading from a stream.
+     *
+     * Files compressed with gzip or zstd are decompressed in parallel where
+     * the format allows it. Define TSV_ENABLE_ZLIB or TSV_ENABLE_ZSTD to 1
+     * and link zlib or libzstd to enable decompression.
+     *
+     * @param path is the path of a file containing a tab-separated document.
+     * @param opts control how the parser behaves.
+     *
+     * @returns A vector of loaded records.
+     */
+    template<typename Record>
+    std::vector<Record> load_file(
+        std::filesystem::path const& path, tsv::options const& opts = {}
+    );
+
+    /**
+     * Traits class for customizing how values of type T are parsed and
+     * formatted. Default implementations for string, char and numeric types
+     * are defined in this library.
+     *
+     * A specialization defines `static T parse(std::string_view text)`, and
+     * `static void format(T const& value, std::string& out)` that appends
+     * the text of a value if the type is written by `tsv::writer`.
      */
     template<typename T>
     struct conversion;
@@ -94,6 +408,13 @@ namespace tsv
          */
         std::size_t line_number = 0;
 
+        /**
+         * Name of the input where the error has occured, such as a file path.
+         * This is set by the loaders reading multiple inputs and is empty
+         * otherwise.
+         */
+        std::string source;
+
         /**
          * Describes the error in detail. This function allocates memory and
          * thus can throw an exception in an out-of-memory case.
@@ -102,9 +423,19 @@ namespace tsv
         {
             std::string message = what();
 
-            if (line_number) {
-                message += " (at line ";
-                message += std::to_string(line_number);
+            if (!source.empty() || line_number) {
+                message += " (";
+                if (!source.empty()) {
+                    message += "in ";
+                    message += source;
+                }
+                if (!source.empty() && line_number) {
+                    message += " ";
+                }
+                if (line_number) {
+                    message += "at line ";
+                    message += std::to_string(line_number);
+                }
                 message += ")";
             }
 
@@ -130,6 +461,10 @@ namespace tsv
             "insufficient number of fields";
         static inline char const* const excess_field =
             "excess fields";
+        static inline char const* const missing_column =
+            "column not found in header";
+        static inline char const* const unwritable_field =
+            "field text contains delimiter or line break";
     };
 
     /** An exception thrown when a text is not parseable as a value. */
@@ -154,6 +489,16 @@ namespace tsv
 
         static inline char const* const unknown =
             "input error";
+        static inline char const* const cannot_open =
+            "cannot open file";
+        static inline char const* const unsupported_compression =
+            "compressed input is not supported in this build";
+        static inline char const* const corrupt_compression =
+            "corrupt compressed input";
+        static inline char const* const corrupt_index =
+            "corrupt index file";
+        static inline char const* const truncated_input =
+            "file was truncated while being read";
     };
 
     /** An exception thrown when validation fails on a record. */
@@ -161,6 +506,9 @@ namespace tsv
     {
     public:
         using tsv::error::error;
+
+        static inline char const* const invalid_record =
+            "record failed batch validation";
     };
 
     /**
@@ -197,6 +545,61 @@ namespace tsv
             throw tsv::validation_error{message};
         }
     }
+
+    /**
+     * Non-owning view of a contiguous sequence of objects, like std::span in
+     * C++20.
+     */
+    template<typename T>
+    class span
+    {
+    public:
+        using element_type = T;
+        using value_type = std::remove_cv_t<T>;
+        using size_type = std::size_t;
+        using iterator = T*;
+
+        span() = default;
+
+        span(T* data, std::size_t size)
+            : _data{data}, _size{size}
+        {
+        }
+
+        T* data() const
+        {
+            return _data;
+        }
+
+        std::size_t size() const
+        {
+            return _size;
+        }
+
+        bool empty() const
+        {
+            return _size == 0;
+        }
+
+        T& operator[](std::size_t index) const
+        {
+            return _data[index];
+        }
+
+        iterator begin() const
+        {
+            return _data;
+        }
+
+        iterator end() const
+        {
+            return _data + _size;
+        }
+
+    private:
+        T* _data = nullptr;
+        std::size_t _size = 0;
+    };
 }
 
 // STRUCTURE REFLECTION ------------------------------------------------------
@@ -210,41 +613,152 @@ namespace tsv::detail
         operator T() const;
     };
 
+    template<std::size_t>
+    using any_at = detail::any;
+
     /**
-     * Traits for detecting the number of fields in an aggregate structure.
-     *
-     * The second parameter is `std::void_t` probing an aggregate initializer.
-     * The third parameter is the type list of the initializers.
-     *
-     * See: https://gist.github.com/utilForever/1a058050b8af3ef46b58bcfa01d5375d
+     * Maximum number of fields detected in an aggregate structure. List the
+     * fields with `tsv::fields` for a larger structure.
      */
-    template<typename Record, typename = void, typename... Inits>
-    struct record_size
-    {
-        static constexpr std::size_t value = 0;
-    };
+    inline constexpr std::size_t max_record_size = 64;
+
+    /**
+     * Traits for checking if an aggregate structure can be initialized with
+     * N initializers. The third parameter is `std::void_t` probing the
+     * aggregate initializer.
+     */
+    template<typename Record, typename Seq, typename = void>
+    struct is_initializable : std::false_type {};
 
 #ifdef __GNUC__
 #  pragma GCC diagnostic push
 #  pragma GCC diagnostic ignored "-Wmissing-field-initializers"
 #endif
-    template<typename Record, typename... Inits>
-    struct record_size<
+    template<typename Record, std::size_t... Is>
+    struct is_initializable<
         Record,
-        std::void_t<decltype(Record{detail::any{}, Inits{}...})>,
-        Inits...
-    >
-    {
-        static constexpr std::size_t value =
-            record_size<Record, void, detail::any, Inits...>::value + 1;
-    };
+        std::index_sequence<Is...>,
+        std::void_t<decltype(Record{detail::any_at<Is>{}...})>
+    > : std::true_type {};
 #ifdef __GNUC__
 #  pragma GCC diagnostic pop
 #endif
 
+    template<typename Record, std::size_t N>
+    inline constexpr bool is_initializable_v =
+        detail::is_initializable<Record, std::make_index_sequence<N>>::value;
+
+    /**
+     * Finds the number of fields of an aggregate structure by binary search
+     * on the number of initializers. A structure initializable with N
+     * initializers is also initializable with fewer, so the search needs
+     * only a logarithmic number of probes. Low is known to be initializable
+     * and High is known to be not.
+     *
+     * See: https://gist.github.com/utilForever/1a058050b8af3ef46b58bcfa01d5375d
+     */
+    template<typename Record, std::size_t Low, std::size_t High>
+    constexpr std::size_t search_record_size()
+    {
+        if constexpr (High - Low <= 1) {
+            return Low;
+        } else {
+            constexpr auto mid = Low + (High - Low) / 2;
+            if constexpr (detail::is_initializable_v<Record, mid>) {
+                return detail::search_record_size<Record, mid, High>();
+            } else {
+                return detail::search_record_size<Record, Low, mid>();
+            }
+        }
+    }
+
+    template<typename Record>
+    constexpr std::size_t count_fields()
+    {
+        static_assert(
+            !detail::is_initializable_v<Record, detail::max_record_size + 1>,
+            "structure has too many fields to detect; list them with tsv::fields"
+        );
+        return detail::search_record_size<Record, 0, detail::max_record_size + 1>();
+    }
+}
+
+namespace tsv
+{
+    /**
+     * Lists the fields of a structure by member pointers in the declaration
+     * order. See `tsv::fields`.
+     */
+    template<auto... Members>
+    struct members {};
+
+    /**
+     * Traits class for listing the fields of a structure explicitly. By
+     * default the fields of an aggregate structure are detected, which works
+     * for up to 64 fields. Specialize this class for a larger structure, or
+     * to skip the detection in the build:
+     *
+     * ```
+     * template<>
+     * struct tsv::fields<my_record>
+     *     : tsv::members<&my_record::id, &my_record::name, &my_record::value>
+     * {
+     * };
+     * ```
+     *
+     * All the fields must be listed in the declaration order.
+     */
+    template<typename Record>
+    struct fields {};
+}
+
+namespace tsv::detail
+{
+    template<auto... Members>
+    tsv::members<Members...> as_members(tsv::members<Members...> const&);
+
+    template<typename Record, typename = void>
+    struct member_list
+    {
+        static constexpr bool listed = false;
+    };
+
+    template<typename Record>
+    struct member_list<
+        Record,
+        std::void_t<decltype(detail::as_members(std::declval<tsv::fields<Record>>()))>
+    >
+    {
+        static constexpr bool listed = true;
+        using type = decltype(detail::as_members(std::declval<tsv::fields<Record>>()));
+    };
+
+    /** True if the fields of a structure are listed with `tsv::fields`. */
+    template<typename Record>
+    inline constexpr bool has_member_list_v = detail::member_list<Record>::listed;
+
+    template<typename Members>
+    struct member_count;
+
+    template<auto... Members>
+    struct member_count<tsv::members<Members...>>
+    {
+        static constexpr std::size_t value = sizeof...(Members);
+    };
+
+    template<typename Record>
+    constexpr std::size_t record_size_of()
+    {
+        if constexpr (detail::has_member_list_v<Record>) {
+            return detail::member_count<typename detail::member_list<Record>::type>::value;
+        } else {
+            return detail::count_fields<Record>();
+        }
+    }
+
     /** Detects the number of fields in an aggregate structure. */
     template<typename Record>
-    inline constexpr std::size_t record_size_v = detail::record_size<Record>::value;
+    inline constexpr std::size_t record_size_v = detail::record_size_of<Record>();
 
     /** A dummy type to hold a template type list. */
     template<typename...>
@@ -267,6 +781,16 @@ namespace tsv::detail
         return detail::type_list<>{};
     }
 
+    /**
+     * Returns a tuple of references to the fields of a structure. The
+     * references are const if Record is a const type.
+     */
+    template<typename Record>
+    auto tie(Record&, detail::size<0>)
+    {
+        return std::tuple<>{};
+    }
+
     // Generate overloads for hard-coded number of fields.
 
 #define TSV_SPLAT(N, ...)                               \
@@ -275,6 +799,13 @@ namespace tsv::detail
     {                                                   \
         auto [__VA_ARGS__] = record;                    \
         return detail::type_list_of(__VA_ARGS__);       \
+    }                                                   \
+                                                        \
+    template<typename Record>                           \
+    auto tie(Record& record, detail::size<N>)           \
+    {                                                   \
+        auto& [__VA_ARGS__] = record;                   \
+        return std::tie(__VA_ARGS__);                   \
     }
 
     TSV_SPLAT(1, a1)
@@ -309,401 +840,7249 @@ namespace tsv::detail
     TSV_SPLAT(30, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14, a15, a16, a17, a18, a19, a20, a21, a22, a23, a24, a25, a26, a27, a28, a29, a30)
     TSV_SPLAT(31, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14, a15, a16, a17, a18, a19, a20, a21, a22, a23, a24, a25, a26, a27, a28, a29, a30, a31)
     TSV_SPLAT(32, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14, a15, a16, a17, a18, a19, a20, a21, a22, a23, a24, a25, a26, a27, a28, a29, a30, a31, a32)
+    TSV_SPLAT(33, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14, a15, a16, a17, a18, a19, a20, a21, a22, a23, a24, a25, a26, a27, a28, a29, a30, a31, a32, a33)
+    TSV_SPLAT(34, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14, a15, a16, a17, a18, a19, a20, a21, a22, a23, a24, a25, a26, a27, a28, a29, a30, a31, a32, a33, a34)
+    TSV_SPLAT(35, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14, a15, a16, a17, a18, a19, a20, a21, a22, a23, a24, a25, a26, a27, a28, a29, a30, a31, a32, a33, a34, a35)
+    TSV_SPLAT(36, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14, a15, a16, a17, a18, a19, a20, a21, a22, a23, a24, a25, a26, a27, a28, a29, a30, a31, a32, a33, a34, a35, a36)
+    TSV_SPLAT(37, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14, a15, a16, a17, a18, a19, a20, a21, a22, a23, a24, a25, a26, a27, a28, a29, a30, a31, a32, a33, a34, a35, a36, a37)
+    TSV_SPLAT(38, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14, a15, a16, a17, a18, a19, a20, a21, a22, a23, a24, a25, a26, a27, a28, a29, a30, a31, a32, a33, a34, a35, a36, a37, a38)
+    TSV_SPLAT(39, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14, a15, a16, a17, a18, a19, a20, a21, a22, a23, a24, a25, a26, a27, a28, a29, a30, a31, a32, a33, a34, a35, a36, a37, a38, a39)
+    TSV_SPLAT(40, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14, a15, a16, a17, a18, a19, a20, a21, a22, a23, a24, a25, a26, a27, a28, a29, a30, a31, a32, a33, a34, a35, a36, a37, a38, a39, a40)
+    TSV_SPLAT(41, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14, a15, a16, a17, a18, a19, a20, a21, a22, a23, a24, a25, a26, a27, a28, a29, a30, a31, a32, a33, a34, a35, a36, a37, a38, a39, a40, a41)
+    TSV_SPLAT(42, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14, a15, a16, a17, a18, a19, a20, a21, a22, a23, a24, a25, a26, a27, a28, a29, a30, a31, a32, a33, a34, a35, a36, a37, a38, a39, a40, a41, a42)
+    TSV_SPLAT(43, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14, a15, a16, a17, a18, a19, a20, a21, a22, a23, a24, a25, a26, a27, a28, a29, a30, a31, a32, a33, a34, a35, a36, a37, a38, a39, a40, a41, a42, a43)
+    TSV_SPLAT(44, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14, a15, a16, a17, a18, a19, a20, a21, a22, a23, a24, a25, a26, a27, a28, a29, a30, a31, a32, a33, a34, a35, a36, a37, a38, a39, a40, a41, a42, a43, a44)
+    TSV_SPLAT(45, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14, a15, a16, a17, a18, a19, a20, a21, a22, a23, a24, a25, a26, a27, a28, a29, a30, a31, a32, a33, a34, a35, a36, a37, a38, a39, a40, a41, a42, a43, a44, a45)
+    TSV_SPLAT(46, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14, a15, a16, a17, a18, a19, a20, a21, a22, a23, a24, a25, a26, a27, a28, a29, a30, a31, a32, a33, a34, a35, a36, a37, a38, a39, a40, a41, a42, a43, a44, a45, a46)
+    TSV_SPLAT(47, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14, a15, a16, a17, a18, a19, a20, a21, a22, a23, a24, a25, a26, a27, a28, a29, a30, a31, a32, a33, a34, a35, a36, a37, a38, a39, a40, a41, a42, a43, a44, a45, a46, a47)
+    TSV_SPLAT(48, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14, a15, a16, a17, a18, a19, a20, a21, a22, a23, a24, a25, a26, a27, a28, a29, a30, a31, a32, a33, a34, a35, a36, a37, a38, a39, a40, a41, a42, a43, a44, a45, a46, a47, a48)
+    TSV_SPLAT(49, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14, a15, a16, a17, a18, a19, a20, a21, a22, a23, a24, a25, a26, a27, a28, a29, a30, a31, a32, a33, a34, a35, a36, a37, a38, a39, a40, a41, a42, a43, a44, a45, a46, a47, a48, a49)
+    TSV_SPLAT(50, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14, a15, a16, a17, a18, a19, a20, a21, a22, a23, a24, a25, a26, a27, a28, a29, a30, a31, a32, a33, a34, a35, a36, a37, a38, a39, a40, a41, a42, a43, a44, a45, a46, a47, a48, a49, a50)
+    TSV_SPLAT(51, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14, a15, a16, a17, a18, a19, a20, a21, a22, a23, a24, a25, a26, a27, a28, a29, a30, a31, a32, a33, a34, a35, a36, a37, a38, a39, a40, a41, a42, a43, a44, a45, a46, a47, a48, a49, a50, a51)
+    TSV_SPLAT(52, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14, a15, a16, a17, a18, a19, a20, a21, a22, a23, a24, a25, a26, a27, a28, a29, a30, a31, a32, a33, a34, a35, a36, a37, a38, a39, a40, a41, a42, a43, a44, a45, a46, a47, a48, a49, a50, a51, a52)
+    TSV_SPLAT(53, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14, a15, a16, a17, a18, a19, a20, a21, a22, a23, a24, a25, a26, a27, a28, a29, a30, a31, a32, a33, a34, a35, a36, a37, a38, a39, a40, a41, a42, a43, a44, a45, a46, a47, a48, a49, a50, a51, a52, a53)
+    TSV_SPLAT(54, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14, a15, a16, a17, a18, a19, a20, a21, a22, a23, a24, a25, a26, a27, a28, a29, a30, a31, a32, a33, a34, a35, a36, a37, a38, a39, a40, a41, a42, a43, a44, a45, a46, a47, a48, a49, a50, a51, a52, a53, a54)
+    TSV_SPLAT(55, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14, a15, a16, a17, a18, a19, a20, a21, a22, a23, a24, a25, a26, a27, a28, a29, a30, a31, a32, a33, a34, a35, a36, a37, a38, a39, a40, a41, a42, a43, a44, a45, a46, a47, a48, a49, a50, a51, a52, a53, a54, a55)
+    TSV_SPLAT(56, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14, a15, a16, a17, a18, a19, a20, a21, a22, a23, a24, a25, a26, a27, a28, a29, a30, a31, a32, a33, a34, a35, a36, a37, a38, a39, a40, a41, a42, a43, a44, a45, a46, a47, a48, a49, a50, a51, a52, a53, a54, a55, a56)
+    TSV_SPLAT(57, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14, a15, a16, a17, a18, a19, a20, a21, a22, a23, a24, a25, a26, a27, a28, a29, a30, a31, a32, a33, a34, a35, a36, a37, a38, a39, a40, a41, a42, a43, a44, a45, a46, a47, a48, a49, a50, a51, a52, a53, a54, a55, a56, a57)
+    TSV_SPLAT(58, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14, a15, a16, a17, a18, a19, a20, a21, a22, a23, a24, a25, a26, a27, a28, a29, a30, a31, a32, a33, a34, a35, a36, a37, a38, a39, a40, a41, a42, a43, a44, a45, a46, a47, a48, a49, a50, a51, a52, a53, a54, a55, a56, a57, a58)
+    TSV_SPLAT(59, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14, a15, a16, a17, a18, a19, a20, a21, a22, a23, a24, a25, a26, a27, a28, a29, a30, a31, a32, a33, a34, a35, a36, a37, a38, a39, a40, a41, a42, a43, a44, a45, a46, a47, a48, a49, a50, a51, a52, a53, a54, a55, a56, a57, a58, a59)
+    TSV_SPLAT(60, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14, a15, a16, a17, a18, a19, a20, a21, a22, a23, a24, a25, a26, a27, a28, a29, a30, a31, a32, a33, a34, a35, a36, a37, a38, a39, a40, a41, a42, a43, a44, a45, a46, a47, a48, a49, a50, a51, a52, a53, a54, a55, a56, a57, a58, a59, a60)
+    TSV_SPLAT(61, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14, a15, a16, a17, a18, a19, a20, a21, a22, a23, a24, a25, a26, a27, a28, a29, a30, a31, a32, a33, a34, a35, a36, a37, a38, a39, a40, a41, a42, a43, a44, a45, a46, a47, a48, a49, a50, a51, a52, a53, a54, a55, a56, a57, a58, a59, a60, a61)
+    TSV_SPLAT(62, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14, a15, a16, a17, a18, a19, a20, a21, a22, a23, a24, a25, a26, a27, a28, a29, a30, a31, a32, a33, a34, a35, a36, a37, a38, a39, a40, a41, a42, a43, a44, a45, a46, a47, a48, a49, a50, a51, a52, a53, a54, a55, a56, a57, a58, a59, a60, a61, a62)
+    TSV_SPLAT(63, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14, a15, a16, a17, a18, a19, a20, a21, a22, a23, a24, a25, a26, a27, a28, a29, a30, a31, a32, a33, a34, a35, a36, a37, a38, a39, a40, a41, a42, a43, a44, a45, a46, a47, a48, a49, a50, a51, a52, a53, a54, a55, a56, a57, a58, a59, a60, a61, a62, a63)
+    TSV_SPLAT(64, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14, a15, a16, a17, a18, a19, a20, a21, a22, a23, a24, a25, a26, a27, a28, a29, a30, a31, a32, a33, a34, a35, a36, a37, a38, a39, a40, a41, a42, a43, a44, a45, a46, a47, a48, a49, a50, a51, a52, a53, a54, a55, a56, a57, a58, a59, a60, a61, a62, a63, a64)
 
 #undef TSV_SPLAT
 
+    template<typename Member>
+    struct member_type;
+
+    template<typename T, typename Record>
+    struct member_type<T Record::*>
+    {
+        using type = T;
+    };
+
+    template<typename Members>
+    struct member_types;
+
+    template<auto... Members>
+    struct member_types<tsv::members<Members...>>
+    {
+        using type = detail::type_list<
+            typename detail::member_type<decltype(Members)>::type...
+        >;
+    };
+
+    template<typename Record, bool = detail::has_member_list_v<Record>>
+    struct field_types
+    {
+        using type = decltype(
+            detail::splat(
+                std::declval<Record>(),
+                detail::size<detail::record_size_v<Record>>{}
+            )
+        );
+    };
+
+    template<typename Record>
+    struct field_types<Record, true>
+    {
+        using type = typename detail::member_types<
+            typename detail::member_list<Record>::type
+        >::type;
+    };
+
     /** Returns a type_list of the fields of an aggregate structure. */
     template<typename Record>
-    using field_type_list = decltype(
-        detail::splat(
-            std::declval<Record>(),
-            detail::size<detail::record_size_v<Record>>{}
-        )
-    );
-}
+    using field_type_list = typename detail::field_types<Record>::type;
 
-// CONVERSION ----------------------------------------------------------------
+    template<typename Record, auto... Members>
+    auto tie_members(Record& record, tsv::members<Members...>)
+    {
+        return std::tie(record.*Members...);
+    }
 
-namespace tsv::detail
-{
     /**
-     * Default implementation for the tsv::conversion traits.
-     *
-     * This fallback definition uses the stream input operator (>>) to read a
-     * value from a stringstream. This is slow.
+     * Returns a tuple of references to the fields of a structure. The
+     * references are const if Record is a const type.
      */
-    template<typename T, typename = void>
+    template<typename Record>
+    auto tie_fields(Record& record)
+    {
+        using record_type = std::remove_const_t<Record>;
+
+        if constexpr (detail::has_member_list_v<record_type>) {
+            return detail::tie_members(
+                record, typename detail::member_list<record_type>::type{}
+            );
+        } else {
+            return detail::tie(record, detail::size<detail::record_size_v<record_type>>{});
+        }
+    }
+
+    /** Checks if a type list contains a type. */
+    template<typename T, typename FieldTypes>
+    struct contains_type;
+
+    template<typename T, typename... Ts>
+    struct contains_type<T, detail::type_list<Ts...>>
+    {
+        static constexpr bool value = (std::is_same_v<T, Ts> || ...);
+    };
+
+    /**
+     * True if a structure has a string_view field, which refers to the input
+     * text and thus requires the text to outlive the structure.
+     */
+    template<typename Record>
+    inline constexpr bool has_view_field_v = detail::contains_type<
+        std::string_view, detail::field_type_list<Record>
+    >::value;
+}
+
+// NUMBER PARSING ------------------------------------------------------------
+
+namespace tsv::detail
+{
+    /** Traits for detecting std::from_chars overload for a type. */
+    template<typename T, typename = void>
+    struct has_from_chars : std::false_type {};
+
+    template<typename T>
+    struct has_from_chars<
+        T,
+        std::void_t<
+            decltype(std::from_chars(nullptr, nullptr, std::declval<T&>()))
+        >
+    > : std::true_type {};
+
+    template<typename T>
+    inline constexpr bool has_from_chars_v = detail::has_from_chars<T>::value;
+
+    /** True if T is an integer type parsed by `detail::parse_integer`. */
+    template<typename T>
+    inline constexpr bool is_fast_integer_v =
+        std::is_integral_v<T> &&
+        !std::is_same_v<T, bool> &&
+        !std::is_same_v<T, char> &&
+        !std::is_same_v<T, wchar_t> &&
+        !std::is_same_v<T, char16_t> &&
+        !std::is_same_v<T, char32_t>;
+
+    /** True if T is a floating-point type parsed by `detail::parse_float`. */
+    template<typename T>
+    inline constexpr bool is_fast_float_v =
+        std::is_same_v<T, float> || std::is_same_v<T, double>;
+
+    template<typename T>
+    inline constexpr bool is_fast_number_v =
+        detail::is_fast_integer_v<T> || detail::is_fast_float_v<T>;
+
+    inline
+    bool is_digit(char ch)
+    {
+        return static_cast<unsigned char>(ch - '0') < 10;
+    }
+
+    /** Locale-independent check for ASCII letters and digits. */
+    inline
+    bool is_alnum(char ch)
+    {
+        auto const lower = static_cast<unsigned char>(ch | 0x20);
+        return detail::is_digit(ch) || static_cast<unsigned char>(lower - 'a') < 26;
+    }
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#  define TSV_SWAR 0
+#else
+#  define TSV_SWAR 1
+#endif
+
+#if TSV_SWAR
+    /** Loads 8 characters as a little-endian 64-bit integer. */
+    inline
+    std::uint64_t load_eight(char const* text)
+    {
+        std::uint64_t chunk;
+        std::memcpy(&chunk, text, sizeof chunk);
+        return chunk;
+    }
+
+    /** Checks if all of the 8 characters packed in an integer are digits. */
+    inline
+    bool is_eight_digits(std::uint64_t chunk)
+    {
+        auto const high = chunk & 0xF0F0F0F0F0F0F0F0;
+        auto const carry = ((chunk + 0x0606060606060606) & 0xF0F0F0F0F0F0F0F0) >> 4;
+        return (high | carry) == 0x3333333333333333;
+    }
+
+    /**
+     * Converts 8 digits packed in an integer to their value. Pairs, quads
+     * and octets of digits are combined with three multiplications.
+     */
+    inline
+    std::uint32_t parse_eight_digits(std::uint64_t chunk)
+    {
+        constexpr std::uint64_t mask = 0x000000FF000000FF;
+        constexpr std::uint64_t mul1 = 100 + (std::uint64_t(1000000) << 32);
+        constexpr std::uint64_t mul2 = 1 + (std::uint64_t(10000) << 32);
+
+        chunk -= 0x3030303030303030;
+        chunk = chunk * 10 + (chunk >> 8);
+        chunk = ((chunk & mask) * mul1 + ((chunk >> 16) & mask) * mul2) >> 32;
+        return static_cast<std::uint32_t>(chunk);
+    }
+#endif
+
+    /**
+     * Parses decimal digits into an unsigned 64-bit integer, eight digits at
+     * a time where possible. Stops at the first non-digit character.
+     *
+     * @param count  Receives the number of significant digits, i.e., the
+     *   digits after leading zeros. The value is exact only if the count is
+     *   at most 19.
+     *
+     * @returns The pointer to the first non-digit character.
+     */
+    inline
+    char const* parse_digits(
+        char const* begin, char const* end, std::uint64_t& value, std::size_t& count
+    )
+    {
+        auto p = begin;
+        while (p != end && *p == '0') {
+            ++p;
+        }
+
+        std::uint64_t acc = 0;
+        std::size_t digits = 0;
+
+#if TSV_SWAR
+        // 16 digits fit in 64 bits, so two chunks can be added without
+        // overflow check.
+        while (end - p >= 8 && digits <= 11) {
+            auto const chunk = detail::load_eight(p);
+            if (!detail::is_eight_digits(chunk)) {
+                break;
+            }
+            acc = acc * 100000000 + detail::parse_eight_digits(chunk);
+            digits += 8;
+            p += 8;
+        }
+#endif
+
+        for (; p != end && detail::is_digit(*p); ++p) {
+            if (digits < 19) {
+                acc = acc * 10 + static_cast<std::uint64_t>(*p - '0');
+            }
+            digits++;
+        }
+
+        value = acc;
+        count = digits;
+        return p;
+    }
+
+    /**
+     * Parses an integer in the same way as std::from_chars with base 10.
+     * Leading '-' is accepted only for signed types.
+     */
+    template<typename T>
+    std::from_chars_result parse_integer(char const* begin, char const* end, T& value)
+    {
+        using unsigned_type = std::make_unsigned_t<T>;
+
+        auto p = begin;
+        bool negative = false;
+
+        if constexpr (std::is_signed_v<T>) {
+            if (p != end && *p == '-') {
+                negative = true;
+                ++p;
+            }
+        }
+
+        if (p == end || !detail::is_digit(*p)) {
+            return {begin, std::errc::invalid_argument};
+        }
+
+        std::uint64_t magnitude;
+        std::size_t digits;
+        p = detail::parse_digits(p, end, magnitude, digits);
+
+        if (digits == 20) {
+            // The magnitude holds the first 19 digits. The last digit may or
+            // may not fit in 64 bits.
+            auto const last = static_cast<std::uint64_t>(p[-1] - '0');
+            if (magnitude > (std::numeric_limits<std::uint64_t>::max() - last) / 10) {
+                return {p, std::errc::result_out_of_range};
+            }
+            magnitude = magnitude * 10 + last;
+        }
+
+        constexpr auto max = static_cast<std::uint64_t>(std::numeric_limits<T>::max());
+        auto const limit = negative ? max + 1 : max;
+
+        if (digits > 20 || magnitude > limit) {
+            return {p, std::errc::result_out_of_range};
+        }
+
+        auto const bits = static_cast<unsigned_type>(magnitude);
+        value = static_cast<T>(negative ? static_cast<unsigned_type>(0u - bits) : bits);
+
+        return {p, std::errc{}};
+    }
+
+    /** Fallback for floating-point types not handled by the fast path. */
+    template<typename T>
+    std::from_chars_result parse_float_slow(char const* begin, char const* end, T& value)
+    {
+        if constexpr (detail::has_from_chars_v<T>) {
+            return std::from_chars(begin, end, value);
+        } else {
+            std::istringstream stream{std::string{begin, end}};
+            stream.imbue(std::locale::classic());
+            stream >> value;
+
+            if (!stream) {
+                return {begin, std::errc::invalid_argument};
+            }
+
+            auto const pos = stream.tellg();
+            auto const length = pos < 0
+                ? static_cast<std::size_t>(end - begin)
+                : static_cast<std::size_t>(pos);
+            return {begin + length, std::errc{}};
+        }
+    }
+
+    /**
+     * Parses a floating-point number in the same way as std::from_chars with
+     * the general format.
+     *
+     * Decimal numbers whose significand and exponent are small enough to be
+     * represented exactly are computed with a single correctly-rounded
+     * multiplication or division (Clinger's fast path). This covers most
+     * real-world data. Other inputs, including infinity and NaN, are handed to
+     * std::from_chars.
+     */
+    template<typename T>
+    std::from_chars_result parse_float(char const* begin, char const* end, T& value)
+    {
+        constexpr std::uint64_t max_significand =
+            std::uint64_t(1) << std::numeric_limits<T>::digits;
+        constexpr int max_exponent = std::is_same_v<T, float> ? 10 : 22;
+        constexpr T powers[] = {
+            T(1e0), T(1e1), T(1e2), T(1e3), T(1e4), T(1e5), T(1e6), T(1e7),
+            T(1e8), T(1e9), T(1e10), T(1e11), T(1e12), T(1e13), T(1e14), T(1e15),
+            T(1e16), T(1e17), T(1e18), T(1e19), T(1e20), T(1e21), T(1e22),
+        };
+
+        auto p = begin;
+        bool const negative = (p != end && *p == '-');
+        if (negative) {
+            ++p;
+        }
+
+        std::uint64_t significand;
+        std::size_t integer_digits;
+        auto const integer_begin = p;
+        p = detail::parse_digits(p, end, significand, integer_digits);
+        auto const has_integer = (p != integer_begin);
+
+        long exponent = 0;
+        std::size_t digits = integer_digits;
+
+        if (p != end && *p == '.') {
+            ++p;
+            auto const fraction_begin = p;
+
+            if (digits == 0) {
+                // Leading zeros of the fraction are not significant.
+                while (p != end && *p == '0') {
+                    ++p;
+                }
+            }
+
+            for (; p != end && detail::is_digit(*p); ++p) {
+                if (digits < 19) {
+                    significand = significand * 10 + static_cast<std::uint64_t>(*p - '0');
+                }
+                digits++;
+            }
+            exponent -= static_cast<long>(p - fraction_begin);
+
+            if (!has_integer && p == fraction_begin) {
+                return detail::parse_float_slow(begin, end, value);
+            }
+        } else if (!has_integer) {
+            return detail::parse_float_slow(begin, end, value);
+        }
+
+        if (p != end && (*p == 'e' || *p == 'E')) {
+            auto q = p + 1;
+            bool exponent_negative = false;
+
+            if (q != end && (*q == '-' || *q == '+')) {
+                exponent_negative = (*q == '-');
+                ++q;
+            }
+
+            if (q == end || !detail::is_digit(*q)) {
+                return detail::parse_float_slow(begin, end, value);
+            }
+
+            long explicit_exponent = 0;
+            for (; q != end && detail::is_digit(*q); ++q) {
+                if (explicit_exponent < 10000) {
+                    explicit_exponent = explicit_exponent * 10 + (*q - '0');
+                }
+            }
+            exponent += exponent_negative ? -explicit_exponent : explicit_exponent;
+            p = q;
+        }
+
+        // Let the slow path handle the characters that may continue a number
+        // (like hexadecimal digits) to replicate std::from_chars exactly.
+        if (p != end && (detail::is_alnum(*p) || *p == '.')) {
+            return detail::parse_float_slow(begin, end, value);
+        }
+
+        if (digits > 19 ||
+            significand > max_significand ||
+            exponent < -max_exponent ||
+            exponent > max_exponent) {
+            return detail::parse_float_slow(begin, end, value);
+        }
+
+        auto result = static_cast<T>(significand);
+        if (exponent < 0) {
+            result /= powers[-exponent];
+        } else {
+            result *= powers[exponent];
+        }
+        value = negative ? -result : result;
+
+        return {p, std::errc{}};
+    }
+
+    /** Parses a number with the fast parser for the type, if any. */
+    template<typename T>
+    std::from_chars_result number_from_chars(char const* begin, char const* end, T& value)
+    {
+        if constexpr (detail::is_fast_integer_v<T>) {
+            return detail::parse_integer(begin, end, value);
+        } else if constexpr (detail::is_fast_float_v<T>) {
+            return detail::parse_float(begin, end, value);
+        } else {
+            return std::from_chars(begin, end, value);
+        }
+    }
+}
+
+// CONVERSION ----------------------------------------------------------------
+
+namespace tsv::detail
+{
+    /**
+     * Default implementation for the tsv::conversion traits.
+     *
+     * This fallback definition uses the stream input operator (>>) to read a
+     * value from a stringstream. This is slow.
+     *
+     * Each default conversion also has a non-throwing `try_parse` function
+     * that returns the error message on failure or null on success, and a
+     * `format` function that appends the text of a value to a string.
+     */
+    template<typename T, typename = void>
     struct default_conversion
     {
         static T parse(std::string_view text)
+        {
+            T value;
+            if (auto const message = try_parse(text, value)) {
+                throw tsv::parse_error{message};
+            }
+            return value;
+        }
+
+        static char const* try_parse(std::string_view text, T& value)
         {
             using char_traits = std::istringstream::traits_type;
 
             std::istringstream stream{std::string{text}};
-            T value;
             stream >> value;
 
             if (!stream) {
-                throw tsv::parse_error{tsv::parse_error::unknown};
+                return tsv::parse_error::unknown;
             }
 
             if (stream.get() != char_traits::eof()) {
-                throw tsv::parse_error{tsv::parse_error::leftover};
+                return tsv::parse_error::leftover;
             }
 
-            return value;
+            return nullptr;
+        }
+
+        static void format(T const& value, std::string& out)
+        {
+            std::ostringstream stream;
+            stream << value;
+            out += stream.str();
         }
     };
 
-    /** An optimized implementation for numeric types using std::from_chars. */
+    /**
+     * An optimized implementation for numeric types. Integers and float and
+     * double use the fast parsers in this library, and other types use
+     * std::from_chars.
+     */
     template<typename T>
     struct default_conversion<
         T,
-        std::void_t<
-            decltype(std::from_chars(nullptr, nullptr, std::declval<T&>()))
-        >
+        std::enable_if_t<detail::is_fast_number_v<T> || detail::has_from_chars_v<T>>
     >
     {
         static T parse(std::string_view text)
+        {
+            T value;
+            if (auto const message = try_parse(text, value)) {
+                throw tsv::parse_error{message};
+            }
+            return value;
+        }
+
+        static char const* try_parse(std::string_view text, T& value)
         {
             auto const begin = text.data();
             auto const end = text.data() + text.size();
 
-            T value;
-            auto const [remain, ec] = std::from_chars(begin, end, value);
+            auto const [remain, ec] = detail::number_from_chars(begin, end, value);
 
             if (ec != std::errc{}) {
-                throw tsv::parse_error{
-                    ec == std::errc::result_out_of_range
-                        ? tsv::parse_error::out_of_range
-                        : tsv::parse_error::unknown
-                };
+                return ec == std::errc::result_out_of_range
+                    ? tsv::parse_error::out_of_range
+                    : tsv::parse_error::unknown;
             }
 
             if (remain != end) {
-                throw tsv::parse_error{tsv::parse_error::leftover};
+                return tsv::parse_error::leftover;
+            }
+
+            return nullptr;
+        }
+
+        /** Formats a value in the shortest text that round-trips. */
+        static void format(T const& value, std::string& out)
+        {
+            char buf[128];
+            auto const result = std::to_chars(buf, buf + sizeof buf, value);
+            out.append(buf, result.ptr);
+        }
+    };
+
+    /** Single-character token. */
+    template<>
+    struct default_conversion<char, void>
+    {
+        static char parse(std::string_view text)
+        {
+            char value;
+            if (auto const message = try_parse(text, value)) {
+                throw tsv::parse_error{message};
             }
+            return value;
+        }
+
+        static char const* try_parse(std::string_view text, char& value)
+        {
+            if (text.size() != 1) {
+                return tsv::parse_error::unknown;
+            }
+            value = text.front();
+            return nullptr;
+        }
+
+        static void format(char value, std::string& out)
+        {
+            out += value;
+        }
+    };
+
+    /** String token. */
+    template<>
+    struct default_conversion<std::string, void>
+    {
+        static std::string parse(std::string_view text)
+        {
+            return std::string{text};
+        }
+
+        static char const* try_parse(std::string_view text, std::string& value)
+        {
+            value.assign(text);
+            return nullptr;
+        }
+
+        static void format(std::string const& value, std::string& out)
+        {
+            out += value;
+        }
+    };
+
+    /**
+     * String token as a view of the input. The view is valid only while the
+     * input is alive, so this type is usable only with the loaders that keep
+     * the input text, like `tsv::load_document`.
+     */
+    template<>
+    struct default_conversion<std::string_view, void>
+    {
+        static std::string_view parse(std::string_view text)
+        {
+            return text;
+        }
+
+        static char const* try_parse(std::string_view text, std::string_view& value)
+        {
+            value = text;
+            return nullptr;
+        }
+
+        static void format(std::string_view value, std::string& out)
+        {
+            out += value;
+        }
+    };
+}
+
+namespace tsv
+{
+    template<typename T>
+    struct conversion : detail::default_conversion<T> {};
+}
+
+namespace tsv::detail
+{
+    /**
+     * Checks if values of type T are parsed by the default conversion, that
+     * is, the conversion traits are not specialized and do not override
+     * the parse function.
+     */
+    template<typename T>
+    constexpr bool uses_default_conversion()
+    {
+        if constexpr (std::is_base_of_v<detail::default_conversion<T>, tsv::conversion<T>>) {
+            return &tsv::conversion<T>::parse == &detail::default_conversion<T>::parse;
+        } else {
+            return false;
+        }
+    }
+
+    template<typename T>
+    struct is_default_conversion
+        : std::bool_constant<detail::uses_default_conversion<T>()> {};
+
+    template<typename T>
+    inline constexpr bool is_default_conversion_v = detail::is_default_conversion<T>::value;
+}
+
+// DICTIONARY ----------------------------------------------------------------
+
+namespace tsv
+{
+    /**
+     * Set of distinct strings, each identified by a 32-bit code. Codes are
+     * assigned in the order the strings are added, starting from zero.
+     */
+    class dictionary
+    {
+    public:
+        dictionary() = default;
+
+        // The index refers to the strings in the storage, so copying is not
+        // trivial. Moving keeps the strings at the same address.
+        dictionary(dictionary const&) = delete;
+        dictionary& operator=(dictionary const&) = delete;
+        dictionary(dictionary&&) = default;
+        dictionary& operator=(dictionary&&) = default;
+
+        /**
+         * Returns the code of a string. The string is added to the dictionary
+         * if it is not in the dictionary yet.
+         */
+        std::uint32_t intern(std::string_view text)
+        {
+            auto const pos = _index.find(text);
+            if (pos != _index.end()) {
+                return pos->second;
+            }
+
+            auto const code = static_cast<std::uint32_t>(_strings.size());
+            _strings.emplace_back(text);
+            _index.emplace(_strings.back(), code);
+            return code;
+        }
+
+        /** Returns the code of a string, or nothing if it is not added. */
+        std::optional<std::uint32_t> find(std::string_view text) const
+        {
+            auto const pos = _index.find(text);
+            if (pos != _index.end()) {
+                return pos->second;
+            }
+            return std::nullopt;
+        }
+
+        /** Returns the string identified by a code. */
+        std::string_view operator[](std::uint32_t code) const
+        {
+            return _strings[code];
+        }
+
+        /** Returns the number of distinct strings. */
+        std::size_t size() const
+        {
+            return _strings.size();
+        }
+
+    private:
+        // Elements of a deque never move, so the index can refer to them.
+        std::deque<std::string> _strings;
+        std::unordered_map<std::string_view, std::uint32_t> _index;
+    };
+
+    /**
+     * Field type for a low-cardinality text column. The text of the field is
+     * stored in a `tsv::dictionary` given to the loader via the `dictionary`
+     * option, and the field holds the code of the text. Tag is an arbitrary
+     * type for distinguishing columns; all interned fields share the same
+     * dictionary regardless of the tag.
+     */
+    template<typename Tag = void>
+    struct interned
+    {
+        std::uint32_t code = 0;
+
+        friend bool operator==(interned const& lhs, interned const& rhs)
+        {
+            return lhs.code == rhs.code;
+        }
+
+        friend bool operator!=(interned const& lhs, interned const& rhs)
+        {
+            return lhs.code != rhs.code;
+        }
+    };
+}
+
+namespace tsv::detail
+{
+    template<typename T>
+    struct is_interned : std::false_type {};
+
+    template<typename Tag>
+    struct is_interned<tsv::interned<Tag>> : std::true_type {};
+
+    /** Checks if a type list contains a specialization of tsv::interned. */
+    template<typename FieldTypes>
+    struct contains_interned;
+
+    template<typename... Ts>
+    struct contains_interned<detail::type_list<Ts...>>
+    {
+        static constexpr bool value = (detail::is_interned<Ts>::value || ...);
+    };
+
+    template<typename Record>
+    inline constexpr bool has_interned_field_v =
+        detail::contains_interned<detail::field_type_list<Record>>::value;
+
+    /**
+     * State needed for parsing values beyond the text itself. A parser holds
+     * a context and passes it to the conversion of every field.
+     */
+    struct parse_context
+    {
+        /** Dictionary for the tsv::interned fields. */
+        tsv::dictionary* dictionary = nullptr;
+
+        /**
+         * Mutex guarding the dictionary and a thread-local cache of codes.
+         * These are set when the dictionary is shared by multiple threads.
+         */
+        std::mutex* dictionary_mutex = nullptr;
+        std::unordered_map<std::string_view, std::uint32_t>* dictionary_cache = nullptr;
+
+        /** Statistics receiving the counts of processed lines and rows. */
+        tsv::load_stats* stats = nullptr;
+
+        /** How special characters in fields are encoded. */
+        tsv::escaping escaping = tsv::escaping::none;
+    };
+
+    /**
+     * Adds the time spent in a scope to a counter. The clock is read only if
+     * TSV_ENABLE_TIMING is nonzero and the counter is not null.
+     */
+    class phase_timer
+    {
+    public:
+#if TSV_ENABLE_TIMING
+        explicit phase_timer(std::chrono::nanoseconds* total)
+            : _total{total}
+        {
+            if (_total) {
+                _start = std::chrono::steady_clock::now();
+            }
+        }
+
+        ~phase_timer()
+        {
+            if (_total) {
+                *_total += std::chrono::steady_clock::now() - _start;
+            }
+        }
+
+        phase_timer(phase_timer const&) = delete;
+        phase_timer& operator=(phase_timer const&) = delete;
+
+    private:
+        std::chrono::nanoseconds* _total;
+        std::chrono::steady_clock::time_point _start;
+#else
+        explicit phase_timer(std::chrono::nanoseconds*)
+        {
+        }
+#endif
+    };
+
+    /** Returns a pointer to a timing counter, or null if stats is null. */
+    inline
+    std::chrono::nanoseconds* phase_counter(
+        tsv::load_stats* stats, std::chrono::nanoseconds tsv::load_stats::* counter
+    )
+    {
+        return stats ? &(stats->*counter) : nullptr;
+    }
+
+    /** Makes the parse context specified by options. */
+    inline
+    detail::parse_context make_context(tsv::options const& opts)
+    {
+        detail::parse_context context;
+        context.dictionary = opts.dictionary;
+        context.stats = opts.stats;
+        context.escaping = opts.escaping;
+        return context;
+    }
+
+    /** Interns a text into the dictionary of a parse context. */
+    inline
+    std::uint32_t intern(std::string_view text, detail::parse_context const& context)
+    {
+        if (!context.dictionary_mutex) {
+            return context.dictionary->intern(text);
+        }
+
+        // Strings in the dictionary never move, so the cache keys can refer
+        // to them without the lock.
+        auto& cache = *context.dictionary_cache;
+        auto const pos = cache.find(text);
+        if (pos != cache.end()) {
+            return pos->second;
+        }
+
+        std::lock_guard<std::mutex> lock{*context.dictionary_mutex};
+        auto const code = context.dictionary->intern(text);
+        cache.emplace((*context.dictionary)[code], code);
+        return code;
+    }
+}
+
+// PARSER --------------------------------------------------------------------
+
+namespace tsv::detail
+{
+    /**
+     * Parses a value of type T from a string. Actual parsing is done by the
+     * tsv::conversion trait.
+     */
+    template<typename T>
+    T parse(std::string_view text)
+    {
+        return tsv::conversion<T>::parse(text);
+    }
+
+    /**
+     * Parses a value of type T from a string, using the context for the types
+     * that need it.
+     */
+    template<typename T>
+    T parse(std::string_view text, detail::parse_context const& context)
+    {
+        if constexpr (detail::is_interned<T>::value) {
+            return T{detail::intern(text, context)};
+        } else {
+            return tsv::conversion<T>::parse(text);
+        }
+    }
+
+    /**
+     * Result of a non-throwing parse. The message is null on success, or one
+     * of the messages defined in `tsv::format_error` or `tsv::parse_error` on
+     * failure.
+     */
+    struct parse_status
+    {
+        enum category_type { parse, format };
+
+        char const* message = nullptr;
+        category_type category = parse;
+
+        bool failed() const
+        {
+            return message != nullptr;
+        }
+    };
+
+    /** Attaches a line and its number to an error. */
+    template<typename Error>
+    Error annotate(Error err, std::string_view line, std::size_t line_number)
+    {
+        err.line = line;
+        err.line_number = line_number;
+        return err;
+    }
+
+    /** Throws the exception for a failed status. */
+    [[noreturn]] inline
+    void raise(
+        detail::parse_status const& status,
+        std::string_view line = {},
+        std::size_t line_number = 0
+    )
+    {
+        if (status.category == detail::parse_status::format) {
+            throw detail::annotate(tsv::format_error{status.message}, line, line_number);
+        }
+        throw detail::annotate(tsv::parse_error{status.message}, line, line_number);
+    }
+
+    /**
+     * Parses a value of type T from a string without throwing on malformed
+     * text. Only the default conversions report errors this way; custom
+     * conversions may still throw. Returns the error message or null.
+     */
+    template<typename T>
+    char const* try_parse(
+        std::string_view text,
+        T& value,
+        [[maybe_unused]] detail::parse_context const& context
+    )
+    {
+        if constexpr (detail::is_interned<T>::value) {
+            value = T{detail::intern(text, context)};
+            return nullptr;
+        } else if constexpr (detail::is_default_conversion_v<T>) {
+            return detail::default_conversion<T>::try_parse(text, value);
+        } else {
+            value = tsv::conversion<T>::parse(text);
+            return nullptr;
+        }
+    }
+
+    /**
+     * Parses a field of type T and records a failure in the status. Nothing
+     * is parsed if the status has already failed, so that the fields of a
+     * record can be parsed in a single pack expansion.
+     */
+    template<typename T>
+    T parse_field(
+        std::string_view text,
+        detail::parse_context const& context,
+        detail::parse_status& status
+    )
+    {
+        T value{};
+        if (!status.failed()) {
+            status.message = detail::try_parse<T>(text, value, context);
+        }
+        return value;
+    }
+
+    /**
+     * Splits a string at a delimiter and consumes the first part.
+     *
+     * @param text  String to split. The string will be trimmed up to the
+     *   first occurrence of the delimiter (or the end).
+     * @param delim  Delimiter character.
+     *
+     * @returns The substring of `text` that precedes the first occurence
+     *   of `delim`. Returns the entire input string if delim is not in the
+     *   input string.
+     */
+    inline
+    std::string_view split_consume(std::string_view& text, char delim)
+    {
+        auto const pos = text.find(delim);
+        if (pos != std::string_view::npos) {
+            auto const token = text.substr(0, pos);
+            text = text.substr(pos + 1);
+            return token;
+        } else {
+            auto const token = text;
+            text = text.substr(text.size());
+            return token;
+        }
+    }
+
+    /** Returns the index of the lowest set bit. The argument must not be zero. */
+    inline
+    unsigned count_trailing_zeros(std::uint64_t bits)
+    {
+#if defined(__GNUC__)
+        return static_cast<unsigned>(__builtin_ctzll(bits));
+#elif defined(_MSC_VER) && defined(_M_X64)
+        unsigned long index;
+        _BitScanForward64(&index, bits);
+        return static_cast<unsigned>(index);
+#else
+        unsigned index = 0;
+        for (; !(bits & 1); bits >>= 1) {
+            index++;
+        }
+        return index;
+#endif
+    }
+
+    /** Size of the block scanned by `detail::match_mask`. */
+    inline constexpr std::size_t scan_block_size = 64;
+
+    /**
+     * Scans a 64-byte block for a character. Returns a bitmask whose i-th bit
+     * is set if and only if `block[i] == ch`.
+     */
+    inline
+    std::uint64_t match_mask(char const* block, char ch)
+    {
+#if TSV_SIMD_AVX2
+        auto const needle = _mm256_set1_epi8(ch);
+        auto const lo = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(block));
+        auto const hi = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(block + 32));
+        auto const lo_mask = static_cast<std::uint32_t>(
+            _mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, needle))
+        );
+        auto const hi_mask = static_cast<std::uint32_t>(
+            _mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, needle))
+        );
+        return std::uint64_t(lo_mask) | (std::uint64_t(hi_mask) << 32);
+#elif TSV_SIMD_SSE2
+        auto const needle = _mm_set1_epi8(ch);
+        std::uint64_t mask = 0;
+        for (int i = 0; i < 4; i++) {
+            auto const chunk = _mm_loadu_si128(reinterpret_cast<__m128i const*>(block + 16 * i));
+            auto const bits = static_cast<std::uint16_t>(
+                _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, needle))
+            );
+            mask |= std::uint64_t(bits) << (16 * i);
+        }
+        return mask;
+#elif TSV_SIMD_NEON
+        auto const needle = vdupq_n_u8(static_cast<std::uint8_t>(ch));
+        auto const data = reinterpret_cast<std::uint8_t const*>(block);
+        uint8x16_t const bit_values = {
+            0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80,
+            0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80
+        };
+        auto const m0 = vandq_u8(vceqq_u8(vld1q_u8(data), needle), bit_values);
+        auto const m1 = vandq_u8(vceqq_u8(vld1q_u8(data + 16), needle), bit_values);
+        auto const m2 = vandq_u8(vceqq_u8(vld1q_u8(data + 32), needle), bit_values);
+        auto const m3 = vandq_u8(vceqq_u8(vld1q_u8(data + 48), needle), bit_values);
+        auto sum = vpaddq_u8(vpaddq_u8(m0, m1), vpaddq_u8(m2, m3));
+        sum = vpaddq_u8(sum, sum);
+        return vgetq_lane_u64(vreinterpretq_u64_u8(sum), 0);
+#else
+        std::uint64_t mask = 0;
+        for (std::size_t i = 0; i < scan_block_size; i++) {
+            mask |= std::uint64_t(block[i] == ch) << i;
+        }
+        return mask;
+#endif
+    }
+
+    /**
+     * Splits a delimited text into fields.
+     *
+     * With SIMD enabled, the splitter finds all delimiters in a 64-byte block
+     * at once and extracts field boundaries from the resulting bitmask. So
+     * the scan is shared by all the fields in a block, which is efficient for
+     * texts having many short fields.
+     */
+    class field_splitter
+    {
+    public:
+        field_splitter(std::string_view text, char delim)
+            : _text{text}, _delim{delim}
+        {
+#if TSV_SIMD
+            load_block();
+#endif
+        }
+
+        /**
+         * Returns true if all fields have been consumed. A text "a|b|"
+         * contains three fields with delim = '|' so this can be false even
+         * if the rest of the text is empty.
+         */
+        bool done() const
+        {
+            return _done;
+        }
+
+        /** Returns the delimiter character. */
+        char delimiter() const
+        {
+            return _delim;
+        }
+
+        /** Consumes the next field. Must not be called if `done()` is true. */
+        std::string_view next()
+        {
+#if TSV_SIMD
+            while (_mask == 0) {
+                _block += scan_block_size;
+                if (_block >= _text.size()) {
+                    return consume_rest();
+                }
+                load_block();
+            }
+
+            auto const pos = _block + detail::count_trailing_zeros(_mask);
+            _mask &= _mask - 1;
+#else
+            auto const pos = _text.find(_delim, _cursor);
+            if (pos == std::string_view::npos) {
+                return consume_rest();
+            }
+#endif
+            auto const field = _text.substr(_cursor, pos - _cursor);
+            _cursor = pos + 1;
+            return field;
+        }
+
+        /** Returns the unconsumed text, which starts at the next field. */
+        std::string_view rest() const
+        {
+            return _text.substr(_cursor);
+        }
+
+        /**
+         * Consumes the next field whose length is already known, e.g., from
+         * parsing the field directly out of `rest()`. The field must be
+         * followed by a delimiter or the end of the text.
+         */
+        void skip(std::size_t length)
+        {
+            auto const pos = _cursor + length;
+
+            if (pos >= _text.size()) {
+                _cursor = _text.size();
+                _done = true;
+                return;
+            }
+            _cursor = pos + 1;
+
+#if TSV_SIMD
+            // Drop the delimiters up to pos from the mask.
+            if (pos >= _block + scan_block_size) {
+                _block = pos - pos % scan_block_size;
+                load_block();
+            }
+            _mask &= ~((std::uint64_t(2) << (pos - _block)) - 1);
+#endif
+        }
+
+    private:
+        std::string_view consume_rest()
+        {
+            auto const field = _text.substr(_cursor);
+            _cursor = _text.size();
+            _done = true;
+            return field;
+        }
+
+#if TSV_SIMD
+        /** Computes the delimiter mask of the block at `_block`. */
+        void load_block()
+        {
+            auto const remain = _text.size() - _block;
+
+            if (remain >= scan_block_size) {
+                _mask = detail::match_mask(_text.data() + _block, _delim);
+            } else {
+                // Avoid reading past the end of the text.
+                char padded[scan_block_size] = {};
+                std::memcpy(padded, _text.data() + _block, remain);
+                _mask = detail::match_mask(padded, _delim);
+                _mask &= (std::uint64_t(1) << remain) - 1;
+            }
+        }
+#endif
+
+    private:
+        std::string_view _text;
+        char _delim;
+        std::size_t _cursor = 0;
+        bool _done = false;
+#if TSV_SIMD
+        std::size_t _block = 0;
+        std::uint64_t _mask = 0;
+#endif
+    };
+
+    /** Returns true if a text contains a backslash. */
+    inline
+    bool has_escape(std::string_view text)
+    {
+        return std::memchr(text.data(), '\\', text.size()) != nullptr;
+    }
+
+    /** Returns true if a line needs to be split with `escaped_splitter`. */
+    inline
+    bool needs_unescape(std::string_view line, detail::parse_context const& context)
+    {
+        return context.escaping == tsv::escaping::backslash && detail::has_escape(line);
+    }
+
+    /**
+     * Splits a delimited text with backslash escapes into fields. A field
+     * without a backslash is returned as a view of the text. A field with
+     * backslashes is unescaped into a scratch buffer, which is reserved for
+     * the whole text so that the returned views stay valid until the buffer
+     * is reused for another text.
+     */
+    class escaped_splitter
+    {
+    public:
+        escaped_splitter(std::string_view text, char delim, std::string& scratch)
+            : _text{text}, _delim{delim}, _scratch{scratch}
+        {
+            _scratch.clear();
+            _scratch.reserve(text.size());
+        }
+
+        /** Returns true if all fields have been consumed. */
+        bool done() const
+        {
+            return _done;
+        }
+
+        /** Returns the delimiter character. */
+        char delimiter() const
+        {
+            return _delim;
+        }
+
+        /** Consumes the next field. Must not be called if `done()` is true. */
+        std::string_view next()
+        {
+            auto pos = _cursor;
+            bool escaped = false;
+
+            while (pos < _text.size() && _text[pos] != _delim) {
+                if (_text[pos] == '\\') {
+                    escaped = true;
+                    if (++pos == _text.size()) {
+                        break;
+                    }
+                }
+                pos++;
+            }
+
+            auto const field = _text.substr(_cursor, pos - _cursor);
+            if (pos >= _text.size()) {
+                _cursor = _text.size();
+                _done = true;
+            } else {
+                _cursor = pos + 1;
+            }
+
+            return escaped ? unescape(field) : field;
+        }
+
+    private:
+        std::string_view unescape(std::string_view field)
+        {
+            auto const start = _scratch.size();
+
+            for (std::size_t i = 0; i < field.size(); i++) {
+                auto ch = field[i];
+                if (ch == '\\' && i + 1 < field.size()) {
+                    ch = field[++i];
+                    switch (ch) {
+                    case 'b': ch = '\b'; break;
+                    case 'f': ch = '\f'; break;
+                    case 'n': ch = '\n'; break;
+                    case 'r': ch = '\r'; break;
+                    case 't': ch = '\t'; break;
+                    case 'v': ch = '\v'; break;
+                    default: break;
+                    }
+                }
+                _scratch.push_back(ch);
+            }
+
+            return std::string_view{_scratch}.substr(start);
+        }
+
+    private:
+        std::string_view _text;
+        char _delim;
+        std::string& _scratch;
+        std::size_t _cursor = 0;
+        bool _done = false;
+    };
+
+    /**
+     * True if a field of type T can be parsed directly from the rest of a
+     * line, without finding the end of the field first. This is the case for
+     * numbers parsed by the default conversion, since the number parser
+     * stops at the delimiter by itself.
+     */
+    template<typename T>
+    inline constexpr bool is_fusable_v = std::conjunction_v<
+        std::bool_constant<
+            (detail::is_fast_number_v<T> || detail::has_from_chars_v<T>) &&
+            !std::is_same_v<T, char>
+        >,
+        detail::is_default_conversion<T>
+    >;
+
+    /**
+     * Checks if numbers can be parsed with the rest of a line in place. This
+     * is not possible if the delimiter can be a part of a number.
+     */
+    inline
+    bool is_fusable_delimiter(char delim)
+    {
+        return !detail::is_alnum(delim) && delim != '.' && delim != '-' && delim != '+';
+    }
+
+    /**
+     * Parses the next field of a row. Numeric fields are parsed straight out
+     * of the rest of the line if `fuse` is true, so the bytes of the field are
+     * scanned only once. On any failure the field is isolated and parsed
+     * again to report the right error. Failures are recorded in the status
+     * as in `detail::parse_field`.
+     */
+    template<typename T, typename Splitter>
+    T parse_next(
+        Splitter& fields,
+        [[maybe_unused]] bool fuse,
+        detail::parse_context const& context,
+        detail::parse_status& status
+    )
+    {
+        if (status.failed()) {
+            return T{};
+        }
+
+        if (fields.done()) {
+            status = {tsv::format_error::missing_field, detail::parse_status::format};
+            return T{};
+        }
+
+        if constexpr (detail::is_fusable_v<T> && std::is_same_v<Splitter, detail::field_splitter>) {
+            if (fuse) {
+                auto const rest = fields.rest();
+                auto const begin = rest.data();
+                auto const end = rest.data() + rest.size();
+
+                T value;
+                auto const [ptr, ec] = detail::number_from_chars(begin, end, value);
+
+                if (ec == std::errc{} && (ptr == end || *ptr == fields.delimiter())) {
+                    fields.skip(static_cast<std::size_t>(ptr - begin));
+                    return value;
+                }
+            }
+        }
+
+        return detail::parse_field<T>(fields.next(), context, status);
+    }
+
+    /**
+     * Parses a structure out of the fields of a splitter without throwing on
+     * malformed text. Ts... is the list of field types. The record is
+     * assigned even on failure, with the fields up to the bad one parsed.
+     *
+     * The field loop is unrolled by the pack expansion, and the conversion of
+     * each field is inlined into it.
+     */
+    template<typename Record, typename Splitter, typename... Ts>
+    detail::parse_status parse_split(
+        Splitter& fields,
+        [[maybe_unused]] bool fuse,
+        detail::type_list<Ts...>,
+        [[maybe_unused]] detail::parse_context const& context,
+        Record& record
+    )
+    {
+        detail::parse_status status;
+
+        // Braced initialization guarantees left-to-right evaluation.
+        record = Record{detail::parse_next<Ts>(fields, fuse, context, status)...};
+
+        if (!status.failed() && !fields.done()) {
+            status = {tsv::format_error::excess_field, detail::parse_status::format};
+        }
+
+        return status;
+    }
+
+    /**
+     * Parses a structure out of a delimited text string without throwing on
+     * malformed text. Ts... is the list of field types. The record is
+     * assigned even on failure, with the fields up to the bad one parsed.
+     */
+    template<typename Record, typename... Ts>
+    detail::parse_status try_parse_record(
+        std::string_view text,
+        char delim,
+        detail::type_list<Ts...> field_types,
+        detail::parse_context const& context,
+        Record& record
+    )
+    {
+        detail::field_splitter fields{text, delim};
+        bool const fuse = detail::is_fusable_delimiter(delim);
+        return detail::parse_split(fields, fuse, field_types, context, record);
+    }
+
+    /**
+     * Parses a structure out of a delimited text string. Record is the type of
+     * the structure to return and Ts... is the list of field types.
+     */
+    template<typename Record, typename... Ts>
+    Record parse_record(
+        std::string_view text,
+        char delim,
+        detail::type_list<Ts...> field_types,
+        detail::parse_context const& context = {}
+    )
+    {
+        Record record;
+        auto const status = detail::try_parse_record(
+            text, delim, field_types, context, record
+        );
+        if (status.failed()) {
+            detail::raise(status);
+        }
+        return record;
+    }
+
+    /**
+     * Mapping from the columns of an input to the fields of a record. The
+     * columns not mapped to any field are skipped without being parsed.
+     */
+    class projection
+    {
+    public:
+        /** Value used for columns not mapped to any field. */
+        static constexpr std::size_t unused = std::size_t(-1);
+
+        /** Constructs an empty projection, which is the identity mapping. */
+        projection() = default;
+
+        /**
+         * Constructs a projection.
+         *
+         * @param columns  The i-th element is the zero-based index of the
+         *   input column mapped to the i-th field. Must not contain duplicates.
+         * @param field_count  The number of fields in the record.
+         */
+        projection(std::vector<std::size_t> const& columns, std::size_t field_count)
+        {
+            if (columns.size() != field_count) {
+                throw std::invalid_argument{
+                    "number of columns does not match number of fields"
+                };
+            }
+
+            for (std::size_t field = 0; field < columns.size(); field++) {
+                auto const column = columns[field];
+                if (column == unused) {
+                    throw std::invalid_argument{"invalid column index"};
+                }
+                if (column >= _fields.size()) {
+                    _fields.resize(column + 1, unused);
+                }
+                if (_fields[column] != unused) {
+                    throw std::invalid_argument{"duplicate column index"};
+                }
+                _fields[column] = field;
+            }
+        }
+
+        /** Returns true if the projection is the identity mapping. */
+        bool empty() const
+        {
+            return _fields.empty();
+        }
+
+        /**
+         * Returns the number of columns to scan, i.e., the largest index of
+         * the selected columns plus one.
+         */
+        std::size_t column_count() const
+        {
+            return _fields.size();
+        }
+
+        /** Returns the field mapped to a column, or `unused`. */
+        std::size_t field(std::size_t column) const
+        {
+            return _fields[column];
+        }
+
+    private:
+        std::vector<std::size_t> _fields;
+    };
+
+    /**
+     * Determines the input columns assigned to the fields of a record, using
+     * the column indices or names given in the options. Returns an empty
+     * vector if the columns are assigned in order.
+     */
+    inline
+    std::vector<std::size_t> bind_columns(
+        tsv::options const& opts, std::vector<std::string> const& header
+    )
+    {
+        if (opts.column_names.empty()) {
+            return opts.columns;
+        }
+
+        if (!opts.columns.empty()) {
+            throw std::invalid_argument{
+                "columns and column_names cannot be used together"
+            };
+        }
+
+        if (!opts.header) {
+            throw std::invalid_argument{"column_names requires header"};
+        }
+
+        std::vector<std::size_t> columns;
+        columns.reserve(opts.column_names.size());
+
+        for (auto const& name : opts.column_names) {
+            auto const pos = std::find(header.begin(), header.end(), name);
+            if (pos == header.end()) {
+                throw tsv::format_error{tsv::format_error::missing_column};
+            }
+            columns.push_back(static_cast<std::size_t>(pos - header.begin()));
+        }
+
+        return columns;
+    }
+
+    /**
+     * Constructs a structure by parsing the texts of its fields. Failures are
+     * recorded in the status as in `detail::parse_field`.
+     */
+    template<typename Record, typename... Ts, std::size_t... Is>
+    Record parse_texts(
+        [[maybe_unused]] std::string_view const* texts,
+        detail::type_list<Ts...>,
+        std::index_sequence<Is...>,
+        [[maybe_unused]] detail::parse_context const& context,
+        [[maybe_unused]] detail::parse_status& status
+    )
+    {
+        return Record{detail::parse_field<Ts>(texts[Is], context, status)...};
+    }
+
+    /** Takes the texts of the fields of a record from a splitter. */
+    template<typename Splitter>
+    detail::parse_status split_fields(
+        Splitter& fields,
+        detail::projection const& projection,
+        std::string_view* texts,
+        std::size_t count
+    )
+    {
+        detail::parse_status const missing_field = {
+            tsv::format_error::missing_field, detail::parse_status::format
+        };
+        detail::parse_status const excess_field = {
+            tsv::format_error::excess_field, detail::parse_status::format
+        };
+
+        if (projection.empty()) {
+            for (std::size_t i = 0; i < count; i++) {
+                if (fields.done()) {
+                    return missing_field;
+                }
+                texts[i] = fields.next();
+            }
+
+            if (!fields.done()) {
+                return excess_field;
+            }
+            return {};
+        }
+
+        // Columns following the last selected one are ignored.
+        for (std::size_t column = 0; column < projection.column_count(); column++) {
+            if (fields.done()) {
+                return missing_field;
+            }
+            auto const field = fields.next();
+            auto const index = projection.field(column);
+            if (index != detail::projection::unused) {
+                texts[index] = field;
+            }
+        }
+
+        return {};
+    }
+
+    /**
+     * Splits a delimited text string into the texts of the fields of a
+     * record. The fields are taken from the columns selected by a projection,
+     * or from all the columns in order if the projection is empty.
+     *
+     * @param text  Delimited text string.
+     * @param delim  Delimiter character.
+     * @param projection  Mapping from columns to fields.
+     * @param texts  Array of size `count` to store the texts of the fields.
+     * @param count  Number of fields in the record.
+     *
+     * @returns Failed status if the text has too few or too many fields.
+     */
+    inline
+    detail::parse_status split_fields(
+        std::string_view text,
+        char delim,
+        detail::projection const& projection,
+        std::string_view* texts,
+        std::size_t count
+    )
+    {
+        detail::field_splitter fields{text, delim};
+        return detail::split_fields(fields, projection, texts, count);
+    }
+
+    /**
+     * Parses a structure out of the columns of a delimited text string that
+     * are selected by a projection, without throwing on malformed text.
+     */
+    template<typename Record, typename... Ts>
+    detail::parse_status try_parse_projected(
+        std::string_view text,
+        char delim,
+        detail::projection const& projection,
+        detail::type_list<Ts...> field_types,
+        detail::parse_context const& context,
+        Record& record
+    )
+    {
+        std::string_view texts[sizeof...(Ts) + 1];
+        auto status = detail::split_fields(text, delim, projection, texts, sizeof...(Ts));
+
+        if (!status.failed()) {
+            record = detail::parse_texts<Record>(
+                texts, field_types, std::index_sequence_for<Ts...>{}, context, status
+            );
+        }
+
+        return status;
+    }
+
+    /**
+     * Parses a structure out of the columns of a delimited text string that
+     * are selected by a projection.
+     */
+    template<typename Record, typename... Ts>
+    Record parse_projected(
+        std::string_view text,
+        char delim,
+        detail::projection const& projection,
+        detail::type_list<Ts...> field_types,
+        detail::parse_context const& context = {}
+    )
+    {
+        Record record;
+        auto const status = detail::try_parse_projected(
+            text, delim, projection, field_types, context, record
+        );
+        if (status.failed()) {
+            detail::raise(status);
+        }
+        return record;
+    }
+
+    /**
+     * Parses a structure out of a delimited text string with backslash
+     * escapes, taking the columns selected by a projection. The fields with
+     * escapes are unescaped into the scratch buffer.
+     */
+    template<typename Record, typename... Ts>
+    detail::parse_status try_parse_escaped(
+        std::string_view text,
+        char delim,
+        detail::projection const& projection,
+        detail::type_list<Ts...> field_types,
+        detail::parse_context const& context,
+        Record& record,
+        std::string& scratch
+    )
+    {
+        detail::escaped_splitter fields{text, delim, scratch};
+
+        if (projection.empty()) {
+            return detail::parse_split(fields, false, field_types, context, record);
+        }
+
+        std::string_view texts[sizeof...(Ts) + 1];
+        auto status = detail::split_fields(fields, projection, texts, sizeof...(Ts));
+
+        if (!status.failed()) {
+            record = detail::parse_texts<Record>(
+                texts, field_types, std::index_sequence_for<Ts...>{}, context, status
+            );
+        }
+
+        return status;
+    }
+
+    /**
+     * Reads blocks of a stream into a ring of buffers on a background thread.
+     * The blocks are handed to the consumer through lock-free indices of the
+     * ring, and the condition variable is used only to sleep when the ring
+     * is full or empty.
+     *
+     * The destructor waits for the background thread, which may be blocked
+     * in reading the stream.
+     */
+    class stream_prefetcher
+    {
+    public:
+        /** Number of blocks in the ring. */
+        static constexpr std::size_t ring_size = 4;
+
+        /**
+         * Starts reading a stream in blocks of given size. Throws
+         * std::system_error if a thread cannot be created.
+         */
+        stream_prefetcher(std::istream& input, std::size_t block_size)
+            : _input{input}, _block_size{block_size}
+        {
+            for (auto& block : _blocks) {
+                block.data.reset(new char[block_size]);
+            }
+            _thread = std::thread{[this] { produce(); }};
+        }
+
+        ~stream_prefetcher()
+        {
+            _stop.store(true);
+            wake();
+            _thread.join();
+        }
+
+        stream_prefetcher(stream_prefetcher const&) = delete;
+        stream_prefetcher& operator=(stream_prefetcher const&) = delete;
+
+        /**
+         * Copies at most `size` bytes of the stream to `dest`. Blocks until
+         * some data is available. Returns the number of bytes copied, which
+         * is zero at the end of the stream.
+         */
+        std::size_t read(char* dest, std::size_t size)
+        {
+            std::size_t copied = 0;
+            auto tail = _tail.load(std::memory_order_relaxed);
+
+            while (copied < size) {
+                if (tail == _head.load(std::memory_order_acquire)) {
+                    if (copied > 0) {
+                        break;
+                    }
+                    if (!wait_block(tail)) {
+                        return 0;
+                    }
+                }
+
+                auto const& block = _blocks[tail % ring_size];
+                auto const count = std::min(size - copied, block.size - _offset);
+                std::memcpy(dest + copied, block.data.get() + _offset, count);
+                copied += count;
+                _offset += count;
+
+                if (_offset == block.size) {
+                    _offset = 0;
+                    tail++;
+                    _tail.store(tail, std::memory_order_release);
+                    wake();
+                }
+            }
+
+            return copied;
+        }
+
+    private:
+        struct block
+        {
+            std::unique_ptr<char[]> data;
+            std::size_t size = 0;
+        };
+
+        /**
+         * Waits until the block at `tail` is produced. Returns false if the
+         * stream has ended. Throws tsv::io_error if reading has failed.
+         */
+        bool wait_block(std::size_t tail)
+        {
+            std::unique_lock<std::mutex> lock{_mutex};
+            _cond.wait(lock, [&] {
+                return tail != _head.load(std::memory_order_acquire) ||
+                    _done.load(std::memory_order_acquire);
+            });
+
+            if (tail != _head.load(std::memory_order_acquire)) {
+                return true;
+            }
+            if (_failed) {
+                throw tsv::io_error{tsv::io_error::unknown};
+            }
+            return false;
+        }
+
+        void produce()
+        {
+            try {
+                for (std::size_t head = 0; ; head++) {
+                    if (!wait_space(head)) {
+                        break;
+                    }
+
+                    auto const buf = _input.rdbuf();
+                    if (!_input || !buf) {
+                        _failed = true;
+                        break;
+                    }
+
+                    auto& block = _blocks[head % ring_size];
+                    auto const count = buf->sgetn(
+                        block.data.get(), static_cast<std::streamsize>(_block_size)
+                    );
+                    if (count <= 0) {
+                        _input.setstate(std::ios::eofbit);
+                        break;
+                    }
+
+                    block.size = static_cast<std::size_t>(count);
+                    _head.store(head + 1, std::memory_order_release);
+                    wake();
+                }
+            } catch (...) {
+                _failed = true;
+            }
+
+            _done.store(true, std::memory_order_release);
+            wake();
+        }
+
+        /** Waits until the ring has room for the block at `head`. */
+        bool wait_space(std::size_t head)
+        {
+            auto const has_space = [&] {
+                return head - _tail.load(std::memory_order_acquire) < ring_size;
+            };
+
+            if (!has_space()) {
+                std::unique_lock<std::mutex> lock{_mutex};
+                _cond.wait(lock, [&] { return has_space() || _stop.load(); });
+            }
+            return !_stop.load();
+        }
+
+        /** Wakes up the other thread if it is sleeping. */
+        void wake()
+        {
+            // Locking ensures that a waiter has either not checked the
+            // condition yet or is already sleeping.
+            { std::lock_guard<std::mutex> lock{_mutex}; }
+            _cond.notify_all();
+        }
+
+    private:
+        std::istream& _input;
+        std::size_t const _block_size;
+        block _blocks[ring_size];
+        std::atomic<std::size_t> _head{0};
+        std::atomic<std::size_t> _tail{0};
+        std::atomic<bool> _done{false};
+        std::atomic<bool> _stop{false};
+        bool _failed = false;
+        std::size_t _offset = 0;
+        std::mutex _mutex;
+        std::condition_variable _cond;
+        std::thread _thread;
+    };
+
+    /** Stream input with the options for `detail::line_reader`. */
+    struct stream_input
+    {
+        std::istream& stream;
+        bool read_ahead = false;
+    };
+
+    /**
+     * Class for reading lines from a stream with one-line lookahead.
+     *
+     * The reader pulls large blocks directly from the stream buffer and finds
+     * lines in the block, so each line costs no virtual call nor copy. Note
+     * that the reader may consume the stream beyond the last line returned.
+     */
+    class line_reader
+    {
+    public:
+        /** Default number of bytes read from the stream at once. */
+        static constexpr std::size_t default_block_size = std::size_t(1) << 20;
+
+        /**
+         * Constructs a reader. If `read_ahead` is true, the stream is read on
+         * a background thread if possible.
+         */
+        explicit line_reader(
+            std::istream& input,
+            std::size_t block_size = default_block_size,
+            bool read_ahead = false
+        )
+            : _input{input}, _capacity{block_size ? block_size : 1}
+        {
+            if (read_ahead) {
+                try {
+                    _prefetcher = std::make_unique<detail::stream_prefetcher>(
+                        input, _capacity
+                    );
+                } catch (std::system_error const&) {
+                    // Fall back to reading on the calling thread.
+                }
+            }
+        }
+
+        explicit line_reader(detail::stream_input const& input)
+            : line_reader{input.stream, default_block_size, input.read_ahead}
+        {
+        }
+
+        /**
+         * Reads next line. Returns a view of the internal buffer containing
+         * the content of the line, or nothing on reaching EOF. The view is
+         * valid until the next call to consume() or peek().
+         */
+        std::optional<std::string_view> consume()
+        {
+            if (!ensure_line()) {
+                return std::nullopt;
+            }
+            _available = false;
+            return _line;
+        }
+
+        /**
+         * Looks next line ahead. Returns a view of the internal buffer
+         * containing the content of the line, or nothing on reaching EOF.
+         */
+        std::optional<std::string_view> peek()
+        {
+            if (!ensure_line()) {
+                return std::nullopt;
+            }
+            return _line;
+        }
+
+        /**
+         * Returns the current line number (one-based). Returns zero if any
+         * line has not been read yet.
+         */
+        std::size_t line_number() const
+        {
+            return _line_number;
+        }
+
+    private:
+        /**
+         * Ensures that `_line` contains the content of the next line. It does
+         * not read from the stream if `_line` is already filled by a previous
+         * lookahead. Returns true on success, or false on reaching EOF.
+         */
+        bool ensure_line()
+        {
+            if (_available) {
+                return true;
+            }
+
+            // Number of bytes after `_begin` known to contain no newline.
+            std::size_t scanned = 0;
+
+            for (;;) {
+                auto const data = _buffer.get();
+                auto const scan_begin = _begin + scanned;
+
+                if (scan_begin < _end) {
+                    auto const newline = static_cast<char const*>(
+                        std::memchr(data + scan_begin, '\n', _end - scan_begin)
+                    );
+                    if (newline) {
+                        auto const pos = static_cast<std::size_t>(newline - data);
+                        _line = std::string_view{data + _begin, pos - _begin};
+                        _begin = pos + 1;
+                        break;
+                    }
+                }
+
+                if (_eof) {
+                    if (_begin == _end) {
+                        return false;
+                    }
+                    // The last line lacks the terminating newline.
+                    _line = std::string_view{data + _begin, _end - _begin};
+                    _begin = _end;
+                    break;
+                }
+
+                scanned = _end - _begin;
+                fill();
+            }
+
+            _line_number++;
+            _available = true;
+
+            return true;
+        }
+
+        /**
+         * Reads next block from the stream into the buffer. Unconsumed data
+         * is moved to the front of the buffer, and the buffer is expanded if
+         * it is full (i.e., if the current line is longer than the buffer).
+         */
+        void fill()
+        {
+            if (!_buffer) {
+                _buffer.reset(new char[_capacity]);
+            }
+
+            if (_begin > 0) {
+                std::memmove(_buffer.get(), _buffer.get() + _begin, _end - _begin);
+                _end -= _begin;
+                _begin = 0;
+            }
+
+            if (_end == _capacity) {
+                auto const new_capacity = _capacity * 2;
+                std::unique_ptr<char[]> new_buffer{new char[new_capacity]};
+                std::memcpy(new_buffer.get(), _buffer.get(), _end);
+                _buffer = std::move(new_buffer);
+                _capacity = new_capacity;
+            }
+
+            // The stream belongs to the background thread if prefetching.
+            if (_prefetcher) {
+                auto const count = _prefetcher->read(
+                    _buffer.get() + _end, _capacity - _end
+                );
+                if (count == 0) {
+                    _eof = true;
+                }
+                _end += count;
+                return;
+            }
+
+            if (_input.eof()) {
+                _eof = true;
+                return;
+            }
+
+            auto const buf = _input.rdbuf();
+            if (!_input || !buf) {
+                throw tsv::io_error{tsv::io_error::unknown};
+            }
+
+            std::streamsize count;
+            try {
+                count = buf->sgetn(
+                    _buffer.get() + _end,
+                    static_cast<std::streamsize>(_capacity - _end)
+                );
+            } catch (...) {
+                throw tsv::io_error{tsv::io_error::unknown};
+            }
+
+            if (count <= 0) {
+                _eof = true;
+                _input.setstate(std::ios::eofbit);
+                return;
+            }
+
+            _end += static_cast<std::size_t>(count);
+        }
+
+    private:
+        std::istream& _input;
+        std::unique_ptr<detail::stream_prefetcher> _prefetcher;
+        std::unique_ptr<char[]> _buffer;
+        std::size_t _capacity;
+        std::size_t _begin = 0;
+        std::size_t _end = 0;
+        std::string_view _line;
+        std::size_t _line_number = 0;
+        bool _available = false;
+        bool _eof = false;
+    };
+
+    /**
+     * Returns the argument to construct a line source of type Source from an
+     * input. Streams are bundled with the options for `detail::line_reader`,
+     * and other inputs are passed through.
+     */
+    template<typename Source, typename Input>
+    decltype(auto) source_input(Input&& input, tsv::options const& opts)
+    {
+        if constexpr (std::is_same_v<Source, detail::line_reader>) {
+            return detail::stream_input{input, opts.read_ahead};
+        } else {
+            return std::forward<Input>(input);
+        }
+    }
+
+    /**
+     * Class for reading lines from an in-memory text with one-line lookahead.
+     * Lines are returned as views of the text itself, so the text must
+     * outlive the reader.
+     */
+    class memory_reader
+    {
+    public:
+        explicit memory_reader(std::string_view text)
+            : _text{text}
+        {
+        }
+
+        /**
+         * Reads next line. Returns a view of the text containing the content
+         * of the line, or nothing on reaching the end.
+         */
+        std::optional<std::string_view> consume()
+        {
+            if (!ensure_line()) {
+                return std::nullopt;
+            }
+            _available = false;
+            return _line;
+        }
+
+        /**
+         * Looks next line ahead. Returns a view of the text containing the
+         * content of the line, or nothing on reaching the end.
+         */
+        std::optional<std::string_view> peek()
+        {
+            if (!ensure_line()) {
+                return std::nullopt;
+            }
+            return _line;
+        }
+
+        /**
+         * Returns the current line number (one-based). Returns zero if any
+         * line has not been read yet.
+         */
+        std::size_t line_number() const
+        {
+            return _line_number;
+        }
+
+        /**
+         * Returns the byte offset of the next unconsumed line in the text.
+         * Returns the size of the text if all lines have been consumed.
+         */
+        std::size_t offset() const
+        {
+            if (_available) {
+                return static_cast<std::size_t>(_line.data() - _text.data());
+            }
+            return _pos;
+        }
+
+    private:
+        bool ensure_line()
+        {
+            if (_available) {
+                return true;
+            }
+
+            if (_pos == _text.size()) {
+                return false;
+            }
+
+            auto const begin = _text.data() + _pos;
+            auto const size = _text.size() - _pos;
+            auto const newline = static_cast<char const*>(
+                std::memchr(begin, '\n', size)
+            );
+
+            if (newline) {
+                auto const length = static_cast<std::size_t>(newline - begin);
+                _line = std::string_view{begin, length};
+                _pos += length + 1;
+            } else {
+                _line = std::string_view{begin, size};
+                _pos += size;
+            }
+
+            _line_number++;
+            _available = true;
+
+            return true;
+        }
+
+    private:
+        std::string_view _text;
+        std::size_t _pos = 0;
+        std::string_view _line;
+        std::size_t _line_number = 0;
+        bool _available = false;
+    };
+
+    /** Set of filters applied to the lines before parsing. */
+    class row_filter
+    {
+    public:
+        row_filter() = default;
+
+        /** Takes filters. The filters are tested in the order of columns. */
+        explicit row_filter(std::vector<tsv::filter> filters)
+            : _filters{std::move(filters)}
+        {
+            for (auto const& filter : _filters) {
+                if (!filter.accept) {
+                    throw std::invalid_argument{"filter has no predicate"};
+                }
+            }
+
+            std::stable_sort(
+                _filters.begin(),
+                _filters.end(),
+                [](tsv::filter const& lhs, tsv::filter const& rhs) {
+                    return lhs.column < rhs.column;
+                }
+            );
+        }
+
+        /** Returns true if there is no filter. */
+        bool empty() const
+        {
+            return _filters.empty();
+        }
+
+        /**
+         * Tests a line. Returns false if the line fails any filter. Returns
+         * true if the line passes all filters or has too few fields to test.
+         * A line with backslash escapes is split and unescaped if `escaped`
+         * is true.
+         */
+        bool accept(std::string_view line, char delim, bool escaped = false) const
+        {
+            if (escaped) {
+                detail::escaped_splitter fields{line, delim, _scratch};
+                return accept_fields(fields);
+            }
+            detail::field_splitter fields{line, delim};
+            return accept_fields(fields);
+        }
+
+    private:
+        template<typename Splitter>
+        bool accept_fields(Splitter& fields) const
+        {
+            std::size_t column = 0;
+            std::string_view text;
+
+            for (auto const& filter : _filters) {
+                while (column <= filter.column) {
+                    if (fields.done()) {
+                        return true;
+                    }
+                    text = fields.next();
+                    column++;
+                }
+
+                if (!filter.accept(text)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        std::vector<tsv::filter> _filters;
+        mutable std::string _scratch;
+    };
+
+    /**
+     * Class for incrementally reading TSV rows from a line source. Source is
+     * a class having `peek()`, `consume()` and `line_number()` member
+     * functions of the same contract as those of `detail::line_reader`.
+     */
+    template<typename Source>
+    class basic_parser
+    {
+    public:
+        /**
+         * Constructs a TSV parser with given input and delimiter. The line
+         * source is constructed from the input.
+         */
+        template<typename Input>
+        explicit basic_parser(
+            Input&& input, char delim, detail::parse_context context = {}
+        )
+            : _source{std::forward<Input>(input)}, _delim{delim}, _context{context}
+        {
+        }
+
+        /** Returns the context passed to field conversions. */
+        detail::parse_context const& context() const
+        {
+            return _context;
+        }
+
+        /**
+         * Sets filters on the following lines. Lines failing the filters are
+         * skipped by `skip_comment`.
+         */
+        void set_filters(std::vector<tsv::filter> const& filters)
+        {
+            _filter = detail::row_filter{filters};
+        }
+
+        /** Returns the number of lines skipped by the filters. */
+        std::size_t filtered() const
+        {
+            return _filtered;
+        }
+
+        /** Skips comment and empty lines and filtered-out lines, if any. */
+        void skip_comment(char prefix)
+        {
+            for (;;) {
+                std::string_view line;
+
+                if (auto maybe_line = peek()) {
+                    line = *maybe_line;
+                } else {
+                    break;
+                }
+
+                if (line.empty() || line.front() == prefix) {
+                    _source.consume();
+                    count_line(line, true);
+                } else if (!_filter.empty() && !_filter.accept(
+                    line, _delim, detail::needs_unescape(line, _context)
+                )) {
+                    _source.consume();
+                    count_line(line, false);
+                    _filtered++;
+                    if (auto const stats = _context.stats) {
+                        stats->filtered_rows++;
+                    }
+                } else {
+                    break;
+                }
+            }
+        }
+
+        /**
+         * Parses the next line as textual fields. The fields are appended to
+         * the end of the vector. Returns true on success or false on reaching
+         * EOF.
+         */
+        bool parse_fields(std::vector<std::string>& fields)
+        {
+            std::string_view line;
+
+            if (auto maybe_line = consume()) {
+                line = *maybe_line;
+            } else {
+                return false;
+            }
+            count_line(line, false);
+
+            if (detail::needs_unescape(line, _context)) {
+                detail::escaped_splitter splitter{line, _delim, _scratch};
+                while (!splitter.done()) {
+                    fields.push_back(std::string{splitter.next()});
+                }
+            } else if (!line.empty()) {
+                detail::field_splitter splitter{line, _delim};
+                while (!splitter.done()) {
+                    fields.push_back(std::string{splitter.next()});
+                }
+            }
+
+            return true;
+        }
+
+        /**
+         * Parses the next line as a structure. The fields are parsed and
+         * assigned to the members of the given structure object. Returns true
+         * on success or false on reaching EOF.
+         */
+        template<typename Record>
+        bool parse_record(Record& record)
+        {
+            return parse_record(record, detail::projection{});
+        }
+
+        /**
+         * Parses the next line as a structure, taking the fields from the
+         * columns selected by a projection. Returns true on success or false
+         * on reaching EOF.
+         */
+        template<typename Record>
+        bool parse_record(Record& record, detail::projection const& projection)
+        {
+            return check(try_parse_record(record, projection));
+        }
+
+        /**
+         * Parses the next line as a structure like `parse_record` but returns
+         * a failed status instead of throwing on a malformed line. Errors
+         * thrown from custom conversions are annotated with the line and
+         * propagated. Returns nullopt on reaching EOF.
+         */
+        template<typename Record>
+        std::optional<detail::parse_status> try_parse_record(
+            Record& record, detail::projection const& projection
+        )
+        {
+            return parse_line([&](std::string_view line) {
+                detail::field_type_list<Record> field_types;
+                if (detail::needs_unescape(line, _context)) {
+                    return detail::try_parse_escaped(
+                        line, _delim, projection, field_types, _context, record, _scratch
+                    );
+                }
+                if (projection.empty()) {
+                    return detail::try_parse_record(
+                        line, _delim, field_types, _context, record
+                    );
+                }
+                return detail::try_parse_projected(
+                    line, _delim, projection, field_types, _context, record
+                );
+            });
+        }
+
+        /**
+         * Splits the next line into the texts of N fields selected by a
+         * projection and calls `visit(texts)` with a pointer to the array of
+         * the texts. Errors thrown from the function are annotated with the
+         * line. Returns true on success or false on reaching EOF.
+         */
+        template<std::size_t N, typename Visit>
+        bool parse_texts(detail::projection const& projection, Visit const& visit)
+        {
+            return check(try_parse_texts<N>(projection, visit));
+        }
+
+        /**
+         * Splits the next line like `parse_texts` but returns a failed status
+         * instead of throwing on a malformed line. The visitor may return a
+         * `detail::parse_status` to report its own failure. Returns nullopt
+         * on reaching EOF.
+         */
+        template<std::size_t N, typename Visit>
+        std::optional<detail::parse_status> try_parse_texts(
+            detail::projection const& projection, Visit const& visit
+        )
+        {
+            return parse_line([&](std::string_view line) {
+                std::string_view texts[N + 1];
+                auto const status = [&] {
+                    if (detail::needs_unescape(line, _context)) {
+                        detail::escaped_splitter fields{line, _delim, _scratch};
+                        return detail::split_fields(fields, projection, texts, N);
+                    }
+                    return detail::split_fields(line, _delim, projection, texts, N);
+                }();
+                if (status.failed()) {
+                    return status;
+                }
+
+                auto const fields = static_cast<std::string_view const*>(texts);
+                if constexpr (std::is_void_v<decltype(visit(fields))>) {
+                    visit(fields);
+                    return detail::parse_status{};
+                } else {
+                    return detail::parse_status{visit(fields)};
+                }
+            });
+        }
+
+        /**
+         * Consumes the next line without splitting it. Returns the line, or
+         * nothing on reaching EOF.
+         */
+        std::optional<std::string_view> read_line()
+        {
+            if (auto maybe_line = consume()) {
+                _line = *maybe_line;
+            } else {
+                return std::nullopt;
+            }
+            count_line(_line, false);
+            return _line;
+        }
+
+        /** Returns the last line consumed by the parser. */
+        std::string_view line() const
+        {
+            return _line;
+        }
+
+        /** Returns the 1-based number of the last line consumed. */
+        std::size_t line_number() const
+        {
+            return _source.line_number();
+        }
+
+    private:
+        /**
+         * Consumes the next line and calls `parse(line)`, which returns the
+         * status of the parse. Errors thrown from the function are annotated
+         * with the line. Returns nullopt on EOF.
+         */
+        template<typename Parse>
+        std::optional<detail::parse_status> parse_line(Parse const& parse)
+        {
+            if (auto maybe_line = consume()) {
+                _line = *maybe_line;
+            } else {
+                return std::nullopt;
+            }
+            count_line(_line, false);
+
+            try {
+                detail::phase_timer const timer{
+                    detail::phase_counter(_context.stats, &tsv::load_stats::parse_time)
+                };
+                return parse(_line);
+            } catch (tsv::error& err) {
+                err.line = _line;
+                err.line_number = _source.line_number();
+                throw;
+            }
+        }
+
+        /** Looks the next line ahead, measuring the read time. */
+        std::optional<std::string_view> peek()
+        {
+            detail::phase_timer const timer{
+                detail::phase_counter(_context.stats, &tsv::load_stats::read_time)
+            };
+            return _source.peek();
+        }
+
+        /** Consumes the next line, measuring the read time. */
+        std::optional<std::string_view> consume()
+        {
+            detail::phase_timer const timer{
+                detail::phase_counter(_context.stats, &tsv::load_stats::read_time)
+            };
+            return _source.consume();
+        }
+
+        /** Counts a consumed line in the statistics, if any. */
+        void count_line(std::string_view line, bool skipped)
+        {
+            if (auto const stats = _context.stats) {
+                stats->bytes += line.size() + 1;
+                stats->lines++;
+                stats->skipped_lines += skipped;
+            }
+        }
+
+        /** Throws if a status has failed. Returns false on EOF. */
+        bool check(std::optional<detail::parse_status> const& status) const
+        {
+            if (!status) {
+                return false;
+            }
+            if (status->failed()) {
+                detail::raise(*status, _line, _source.line_number());
+            }
+            return true;
+        }
+
+    private:
+        Source _source;
+        char const _delim;
+        detail::parse_context const _context;
+        std::string_view _line;
+        detail::row_filter _filter;
+        std::size_t _filtered = 0;
+        std::string _scratch;
+    };
+
+    /** Class for incrementally reading TSV rows from a stream. */
+    using parser = detail::basic_parser<detail::line_reader>;
+}
+
+// THREAD POOL ---------------------------------------------------------------
+
+namespace tsv::detail
+{
+    /** Returns the number of worker threads to use for a request. */
+    inline
+    std::size_t thread_count(std::size_t requested)
+    {
+        if (requested == 0) {
+            requested = std::thread::hardware_concurrency();
+        }
+        return requested ? requested : 1;
+    }
+
+    /**
+     * Calls `task(i)` for each i in [0, count) on a pool of threads. Tasks are
+     * dynamically assigned to idle threads. The task must not throw. Fewer
+     * threads are used if the system fails to create threads.
+     */
+    template<typename Task>
+    void run_parallel(std::size_t count, std::size_t threads, Task const& task)
+    {
+        std::atomic<std::size_t> next{0};
+
+        auto const worker = [&] {
+            for (;;) {
+                auto const i = next.fetch_add(1, std::memory_order_relaxed);
+                if (i >= count) {
+                    break;
+                }
+                task(i);
+            }
+        };
+
+        std::vector<std::thread> pool;
+        auto const extra = std::min(threads, count);
+
+        try {
+            for (std::size_t i = 1; i < extra; i++) {
+                pool.emplace_back(worker);
+            }
+        } catch (std::system_error const&) {
+            // Continue with the threads successfully created.
+        }
+
+        worker();
+
+        for (auto& thread : pool) {
+            thread.join();
+        }
+    }
+}
+
+// COMPRESSED INPUT ----------------------------------------------------------
+
+namespace tsv::detail
+{
+    /** Compression formats detected in file inputs. */
+    enum class compression
+    {
+        none,
+        gzip,
+        zstd,
+    };
+
+    /** Detects the compression format of data by its magic bytes. */
+    inline
+    detail::compression detect_compression(std::string_view data)
+    {
+        if (data.substr(0, 2) == std::string_view{"\x1f\x8b", 2}) {
+            return detail::compression::gzip;
+        }
+        if (data.substr(0, 4) == std::string_view{"\x28\xb5\x2f\xfd", 4}) {
+            return detail::compression::zstd;
+        }
+        return detail::compression::none;
+    }
+
+    /**
+     * Independently compressed part of an input and the location of its
+     * decompressed content in the output.
+     */
+    struct compressed_block
+    {
+        std::string_view data;
+        std::size_t output_offset = 0;
+        std::size_t output_size = 0;
+    };
+
+    /**
+     * Decompresses the blocks into the output in parallel. The output must
+     * be sized for all the blocks. `decompress(block, dest)` returns false
+     * if a block is corrupt.
+     */
+    template<typename Decompress>
+    void decompress_blocks(
+        std::vector<detail::compressed_block> const& blocks,
+        std::vector<char>& output,
+        Decompress const& decompress
+    )
+    {
+        std::atomic<bool> failed{false};
+
+        detail::run_parallel(blocks.size(), detail::thread_count(0), [&](std::size_t i) {
+            if (failed.load(std::memory_order_relaxed)) {
+                return;
+            }
+            auto const& block = blocks[i];
+            if (!decompress(block, output.data() + block.output_offset)) {
+                failed.store(true, std::memory_order_relaxed);
+            }
+        });
+
+        if (failed.load()) {
+            throw tsv::io_error{tsv::io_error::corrupt_compression};
+        }
+    }
+
+    /** Reads a little-endian integer of N bytes. */
+    template<std::size_t N>
+    std::size_t read_le(char const* data)
+    {
+        std::size_t value = 0;
+        for (std::size_t i = N; i-- > 0; ) {
+            value = value << 8 | static_cast<unsigned char>(data[i]);
+        }
+        return value;
+    }
+
+#if TSV_ENABLE_ZLIB
+    /**
+     * Splits BGZF (blocked gzip) data into its gzip members. Each member
+     * records its compressed size in the BC extra field and its decompressed
+     * size in the trailer. Returns false if the data is not BGZF.
+     */
+    inline
+    bool split_bgzf(std::string_view data, std::vector<detail::compressed_block>& blocks)
+    {
+        constexpr std::size_t header_size = 12;
+        constexpr std::size_t trailer_size = 8;
+        constexpr unsigned char extra_flag = 4;
+
+        std::size_t output_size = 0;
+
+        while (!data.empty()) {
+            if (data.size() < header_size ||
+                detail::detect_compression(data) != detail::compression::gzip ||
+                !(static_cast<unsigned char>(data[3]) & extra_flag)) {
+                return false;
+            }
+
+            auto const extra_size = detail::read_le<2>(data.data() + 10);
+            auto extra = data.substr(header_size, extra_size);
+            if (extra.size() != extra_size) {
+                return false;
+            }
+
+            std::size_t block_size = 0;
+            while (extra.size() >= 4) {
+                auto const field_size = detail::read_le<2>(extra.data() + 2);
+                if (extra[0] == 'B' && extra[1] == 'C' && field_size == 2 && extra.size() >= 6) {
+                    block_size = detail::read_le<2>(extra.data() + 4) + 1;
+                    break;
+                }
+                extra.remove_prefix(std::min(extra.size(), 4 + field_size));
+            }
+
+            if (block_size < header_size + extra_size + trailer_size ||
+                block_size > data.size()) {
+                return false;
+            }
+
+            detail::compressed_block block;
+            block.data = data.substr(0, block_size);
+            block.output_offset = output_size;
+            block.output_size = detail::read_le<4>(data.data() + block_size - 4);
+            blocks.push_back(block);
+
+            output_size += block.output_size;
+            data.remove_prefix(block_size);
+        }
+
+        return true;
+    }
+
+    /** Owns a zlib stream for inflating gzip data. */
+    class inflater
+    {
+    public:
+        inflater()
+        {
+            // 15 is the maximum window size and 16 selects the gzip format.
+            if (inflateInit2(&_stream, 15 + 16) != Z_OK) {
+                throw std::bad_alloc{};
+            }
+        }
+
+        ~inflater()
+        {
+            inflateEnd(&_stream);
+        }
+
+        inflater(inflater const&) = delete;
+        inflater& operator=(inflater const&) = delete;
+
+        z_stream* get()
+        {
+            return &_stream;
+        }
+
+    private:
+        z_stream _stream = {};
+    };
+
+    /** Decompresses gzip data, which may consist of multiple members. */
+    inline
+    std::vector<char> decompress_gzip(std::string_view data)
+    {
+        std::vector<detail::compressed_block> blocks;
+
+        if (detail::split_bgzf(data, blocks)) {
+            std::vector<char> output(
+                blocks.empty() ? 0 : blocks.back().output_offset + blocks.back().output_size
+            );
+
+            detail::decompress_blocks(blocks, output, [](auto const& block, char* dest) {
+                detail::inflater inflater;
+                auto const stream = inflater.get();
+                char dummy;
+
+                stream->next_in = reinterpret_cast<Bytef*>(const_cast<char*>(block.data.data()));
+                stream->avail_in = static_cast<uInt>(block.data.size());
+                stream->next_out = reinterpret_cast<Bytef*>(block.output_size ? dest : &dummy);
+                stream->avail_out = static_cast<uInt>(block.output_size);
+
+                return inflate(stream, Z_FINISH) == Z_STREAM_END &&
+                    stream->avail_out == 0 && stream->avail_in == 0;
+            });
+
+            return output;
+        }
+
+        // Plain gzip has no index of the members, so it is inflated serially.
+        constexpr std::size_t max_chunk = std::numeric_limits<uInt>::max();
+
+        std::vector<char> output(std::max(data.size() * 4, std::size_t(1) << 16));
+        std::size_t output_size = 0;
+
+        detail::inflater inflater;
+        auto const stream = inflater.get();
+
+        for (;;) {
+            if (output_size == output.size()) {
+                output.resize(output.size() * 2);
+            }
+
+            auto const input_chunk = std::min(data.size(), max_chunk);
+            auto const output_chunk = std::min(output.size() - output_size, max_chunk);
+
+            stream->next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+            stream->avail_in = static_cast<uInt>(input_chunk);
+            stream->next_out = reinterpret_cast<Bytef*>(output.data() + output_size);
+            stream->avail_out = static_cast<uInt>(output_chunk);
+
+            auto const status = inflate(stream, Z_NO_FLUSH);
+
+            data.remove_prefix(input_chunk - stream->avail_in);
+            output_size += output_chunk - stream->avail_out;
+
+            if (status == Z_STREAM_END) {
+                if (data.empty()) {
+                    break;
+                }
+                // Continue with the next member.
+                inflateReset(stream);
+                continue;
+            }
+
+            // Running out of output space is the only expected stall.
+            if (status != Z_OK && !(status == Z_BUF_ERROR && output_size == output.size())) {
+                throw tsv::io_error{tsv::io_error::corrupt_compression};
+            }
+        }
+
+        output.resize(output_size);
+        return output;
+    }
+#endif
+
+#if TSV_ENABLE_ZSTD
+    /**
+     * Splits zstd data into frames. Returns false if some frame lacks the
+     * decompressed size. Throws tsv::io_error if the data is corrupt.
+     */
+    inline
+    bool split_zstd(std::string_view data, std::vector<detail::compressed_block>& blocks)
+    {
+        std::size_t output_size = 0;
+        bool sized = true;
+
+        while (!data.empty()) {
+            auto const frame_size = ZSTD_findFrameCompressedSize(data.data(), data.size());
+            if (ZSTD_isError(frame_size)) {
+                throw tsv::io_error{tsv::io_error::corrupt_compression};
+            }
+
+            auto const content_size = ZSTD_getFrameContentSize(data.data(), frame_size);
+            if (content_size == ZSTD_CONTENTSIZE_UNKNOWN ||
+                content_size == ZSTD_CONTENTSIZE_ERROR) {
+                sized = false;
+            }
+
+            detail::compressed_block block;
+            block.data = data.substr(0, frame_size);
+            block.output_offset = output_size;
+            block.output_size = sized ? static_cast<std::size_t>(content_size) : 0;
+            blocks.push_back(block);
+
+            output_size += block.output_size;
+            data.remove_prefix(frame_size);
+        }
+
+        return sized;
+    }
+
+    /** Decompresses zstd data, which may consist of multiple frames. */
+    inline
+    std::vector<char> decompress_zstd(std::string_view data)
+    {
+        std::vector<detail::compressed_block> blocks;
+
+        if (detail::split_zstd(data, blocks)) {
+            std::vector<char> output(
+                blocks.empty() ? 0 : blocks.back().output_offset + blocks.back().output_size
+            );
+
+            detail::decompress_blocks(blocks, output, [](auto const& block, char* dest) {
+                auto const size = ZSTD_decompress(
+                    dest, block.output_size, block.data.data(), block.data.size()
+                );
+                return !ZSTD_isError(size) && size == block.output_size;
+            });
+
+            return output;
+        }
+
+        // Frames without the content size are decompressed serially.
+        std::unique_ptr<ZSTD_DStream, decltype(&ZSTD_freeDStream)> stream{
+            ZSTD_createDStream(), &ZSTD_freeDStream
+        };
+        if (!stream) {
+            throw std::bad_alloc{};
+        }
+
+        std::vector<char> output(std::max(data.size() * 4, ZSTD_DStreamOutSize()));
+        ZSTD_inBuffer input = {data.data(), data.size(), 0};
+        ZSTD_outBuffer out = {output.data(), output.size(), 0};
+
+        for (;;) {
+            if (out.pos == out.size) {
+                output.resize(output.size() * 2);
+                out.dst = output.data();
+                out.size = output.size();
+            }
+
+            auto const status = ZSTD_decompressStream(stream.get(), &out, &input);
+            if (ZSTD_isError(status)) {
+                throw tsv::io_error{tsv::io_error::corrupt_compression};
+            }
+
+            if (input.pos == input.size && out.pos < out.size) {
+                // Nonzero status means that the last frame is truncated.
+                if (status != 0) {
+                    throw tsv::io_error{tsv::io_error::corrupt_compression};
+                }
+                break;
+            }
+        }
+
+        output.resize(out.pos);
+        return output;
+    }
+#endif
+
+    /**
+     * Decompresses data in a given format. Throws tsv::io_error if support
+     * for the format is not enabled by the TSV_ENABLE_ZLIB or TSV_ENABLE_ZSTD
+     * macro.
+     */
+    inline
+    std::vector<char> decompress(
+        [[maybe_unused]] std::string_view data, detail::compression format
+    )
+    {
+#if TSV_ENABLE_ZLIB
+        if (format == detail::compression::gzip) {
+            return detail::decompress_gzip(data);
+        }
+#endif
+#if TSV_ENABLE_ZSTD
+        if (format == detail::compression::zstd) {
+            return detail::decompress_zstd(data);
+        }
+#endif
+        static_cast<void>(format);
+        throw tsv::io_error{tsv::io_error::unsupported_compression};
+    }
+}
+
+// FILE INPUT ----------------------------------------------------------------
+
+namespace tsv::detail
+{
+    /**
+     * Read-only content of a file. A regular file is memory-mapped with a
+     * sequential access hint. Other files (e.g., pipes) and platforms without
+     * mmap fall back to reading the whole content into a heap buffer. The
+     * content stays at the same address when the object is moved.
+     *
+     * A file compressed with gzip or zstd is detected by its magic bytes and
+     * decompressed into a heap buffer, if supported by the build.
+     */
+    class mapped_file
+    {
+    public:
+        /** Reads the whole content of a stream into a heap buffer. */
+        explicit mapped_file(std::istream& input)
+        {
+            auto const buf = input.rdbuf();
+            if (!input || !buf) {
+                throw tsv::io_error{tsv::io_error::unknown};
+            }
+
+            std::size_t size = 0;
+            for (;;) {
+                _storage.resize(size + read_size);
+
+                std::streamsize count;
+                try {
+                    count = buf->sgetn(
+                        _storage.data() + size,
+                        static_cast<std::streamsize>(read_size)
+                    );
+                } catch (...) {
+                    throw tsv::io_error{tsv::io_error::unknown};
+                }
+
+                if (count <= 0) {
+                    input.setstate(std::ios::eofbit);
+                    break;
+                }
+                size += static_cast<std::size_t>(count);
+            }
+            _storage.resize(size);
+            _data = _storage.data();
+            _size = size;
+        }
+
+        explicit mapped_file(std::filesystem::path const& path)
+        {
+#if TSV_USE_MMAP
+            int const fd = ::open(path.c_str(), O_RDONLY);
+            if (fd == -1) {
+                throw tsv::io_error{tsv::io_error::cannot_open};
+            }
+
+            struct ::stat status;
+            if (::fstat(fd, &status) == 0 && S_ISREG(status.st_mode) && status.st_size > 0) {
+                auto const size = static_cast<std::size_t>(status.st_size);
+                void* const addr = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (addr != MAP_FAILED) {
+                    ::madvise(addr, size, MADV_SEQUENTIAL);
+                    _data = static_cast<char const*>(addr);
+                    _size = size;
+                    _mapped = true;
+                }
+            }
+
+            if (!_mapped) {
+                try {
+                    read_all(fd);
+                } catch (...) {
+                    ::close(fd);
+                    throw;
+                }
+            }
+            ::close(fd);
+#else
+            std::ifstream file{path, std::ios::binary};
+            if (!file) {
+                throw tsv::io_error{tsv::io_error::cannot_open};
+            }
+
+            std::size_t size = 0;
+            for (;;) {
+                _storage.resize(size + read_size);
+                file.read(_storage.data() + size, static_cast<std::streamsize>(read_size));
+                size += static_cast<std::size_t>(file.gcount());
+                if (!file) {
+                    if (!file.eof()) {
+                        throw tsv::io_error{tsv::io_error::unknown};
+                    }
+                    break;
+                }
+            }
+            _storage.resize(size);
+            _data = _storage.data();
+            _size = size;
+#endif
+
+            auto const format = detail::detect_compression(view());
+            if (format != detail::compression::none) {
+                std::vector<char> text;
+                try {
+                    text = detail::decompress(view(), format);
+                } catch (...) {
+                    unmap();
+                    throw;
+                }
+                unmap();
+
+                _storage = std::move(text);
+                _data = _storage.data();
+                _size = _storage.size();
+            }
+        }
+
+        mapped_file(mapped_file const&) = delete;
+        mapped_file& operator=(mapped_file const&) = delete;
+
+        mapped_file(mapped_file&& other) noexcept
+            : _data{other._data}
+            , _size{other._size}
+            , _mapped{other._mapped}
+            , _storage{std::move(other._storage)}
+        {
+            other._data = nullptr;
+            other._size = 0;
+            other._mapped = false;
+        }
+
+        mapped_file& operator=(mapped_file&& other) noexcept
+        {
+            mapped_file tmp{std::move(other)};
+            std::swap(_data, tmp._data);
+            std::swap(_size, tmp._size);
+            std::swap(_mapped, tmp._mapped);
+            std::swap(_storage, tmp._storage);
+            return *this;
+        }
+
+        ~mapped_file()
+        {
+            unmap();
+        }
+
+        /** Returns a view of the content of the file. */
+        std::string_view view() const
+        {
+            return std::string_view{_data, _size};
+        }
+
+    private:
+        static constexpr std::size_t read_size = std::size_t(1) << 20;
+
+        void unmap()
+        {
+#if TSV_USE_MMAP
+            if (_mapped) {
+                ::munmap(const_cast<char*>(_data), _size);
+                _mapped = false;
+            }
+#endif
+        }
+
+#if TSV_USE_MMAP
+        void read_all(int fd)
+        {
+            std::size_t size = 0;
+            for (;;) {
+                _storage.resize(size + read_size);
+                auto const count = ::read(fd, _storage.data() + size, read_size);
+                if (count < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    throw tsv::io_error{tsv::io_error::unknown};
+                }
+                if (count == 0) {
+                    break;
+                }
+                size += static_cast<std::size_t>(count);
+            }
+            _storage.resize(size);
+            _data = _storage.data();
+            _size = size;
+        }
+#endif
+
+    private:
+        char const* _data = nullptr;
+        std::size_t _size = 0;
+        bool _mapped = false;
+        std::vector<char> _storage;
+    };
+
+    /** Line source reading zero-copy lines from a mapped file. */
+    class file_line_reader
+    {
+    public:
+        explicit file_line_reader(std::filesystem::path const& path)
+            : _file{path}, _lines{_file.view()}
+        {
+        }
+
+        std::optional<std::string_view> consume()
+        {
+            return _lines.consume();
+        }
+
+        std::optional<std::string_view> peek()
+        {
+            return _lines.peek();
+        }
+
+        std::size_t line_number() const
+        {
+            return _lines.line_number();
+        }
+
+    private:
+        detail::mapped_file _file;
+        detail::memory_reader _lines;
+    };
+}
+
+// BINARY CACHE --------------------------------------------------------------
+
+namespace tsv::detail
+{
+    /** Incremental FNV-1a hash. */
+    class hasher
+    {
+    public:
+        void add(void const* data, std::size_t size)
+        {
+            auto const bytes = static_cast<unsigned char const*>(data);
+            for (std::size_t i = 0; i < size; i++) {
+                _state = (_state ^ bytes[i]) * 1099511628211u;
+            }
+        }
+
+        void add(std::string_view text)
+        {
+            add(std::uint64_t(text.size()));
+            add(text.data(), text.size());
+        }
+
+        void add(std::uint64_t value)
+        {
+            add(&value, sizeof value);
+        }
+
+        std::uint64_t value() const
+        {
+            return _state;
+        }
+
+    private:
+        std::uint64_t _state = 14695981039346656037u;
+    };
+
+    /**
+     * True if an enumeration type has a fixed underlying type, so that every
+     * value of the underlying type is a valid value of the enumeration.
+     */
+    template<typename T, typename = void>
+    struct has_fixed_underlying_type : std::false_type {};
+
+    template<typename T>
+    struct has_fixed_underlying_type<
+        T, std::void_t<decltype(T{std::underlying_type_t<T>{}})>
+    > : std::true_type {};
+
+    /** Checks if saved enumeration values can be restored without UB. */
+    template<typename T>
+    constexpr bool is_cacheable_enum()
+    {
+        if constexpr (std::is_enum_v<T>) {
+            return detail::has_fixed_underlying_type<T>::value;
+        } else {
+            return true;
+        }
+    }
+
+    /**
+     * True if a field of type T can be saved in a cache. Trivially copyable
+     * values are saved as is and strings are saved with their lengths.
+     * Pointers, views and interned codes are only valid in a process, and
+     * enumerations without a fixed underlying type cannot hold every saved
+     * value.
+     */
+    template<typename T>
+    inline constexpr bool is_cacheable_field_v =
+        std::is_same_v<T, std::string> || (
+            std::is_trivially_copyable_v<T> &&
+            !std::is_pointer_v<T> &&
+            !std::is_same_v<T, std::string_view> &&
+            !detail::is_interned<T>::value &&
+            detail::is_cacheable_enum<T>()
+        );
+
+    /**
+     * True if any bytes read from a cache form a valid value of type T.
+     * Booleans and enumerations are checked field by field instead.
+     */
+    template<typename T>
+    inline constexpr bool is_raw_field_v =
+        std::is_arithmetic_v<T> && !std::is_same_v<T, bool>;
+
+    template<typename FieldTypes>
+    struct cacheable_fields;
+
+    template<typename... Ts>
+    struct cacheable_fields<detail::type_list<Ts...>>
+    {
+        static constexpr bool value = (detail::is_cacheable_field_v<Ts> && ...);
+        static constexpr bool raw = (detail::is_raw_field_v<Ts> && ...);
+    };
+
+    /** True if records of the type can be saved in a cache. */
+    template<typename Record>
+    inline constexpr bool is_cacheable_v =
+        detail::cacheable_fields<detail::field_type_list<Record>>::value;
+
+    /**
+     * True if records of the type are cached as raw bytes. Records with
+     * fields other than numbers are cached field by field, so that a corrupt
+     * cache cannot produce invalid values.
+     */
+    template<typename Record>
+    inline constexpr bool is_raw_cacheable_v =
+        detail::is_cacheable_v<Record> &&
+        detail::cacheable_fields<detail::field_type_list<Record>>::raw &&
+        std::is_trivially_copyable_v<Record>;
+
+    /** Returns a code for the kind of a field type. */
+    template<typename T>
+    constexpr std::uint64_t field_kind()
+    {
+        if constexpr (std::is_same_v<T, std::string>) {
+            return 1;
+        } else if constexpr (std::is_same_v<T, bool>) {
+            return 2;
+        } else if constexpr (std::is_floating_point_v<T>) {
+            return 3;
+        } else if constexpr (std::is_integral_v<T>) {
+            return std::is_signed_v<T> ? 4 : 5;
+        } else if constexpr (std::is_enum_v<T>) {
+            return 6;
+        } else {
+            return 7;
+        }
+    }
+
+    /** Hashes the memory layout of a record type. */
+    template<typename Record, typename... Ts, std::size_t... Is>
+    std::uint64_t layout_hash(detail::type_list<Ts...>, std::index_sequence<Is...>)
+    {
+        detail::hasher hasher;
+        hasher.add(std::uint64_t(sizeof(Record)));
+        hasher.add(std::uint64_t(alignof(Record)));
+        hasher.add(std::uint64_t(sizeof...(Ts)));
+
+        Record const record{};
+        [[maybe_unused]] auto const base = reinterpret_cast<char const*>(&record);
+        [[maybe_unused]] auto const fields = detail::tie_fields(record);
+
+        (hasher.add(detail::field_kind<Ts>()), ...);
+        (hasher.add(std::uint64_t(sizeof(Ts))), ...);
+        (hasher.add(std::uint64_t(
+            reinterpret_cast<char const*>(&std::get<Is>(fields)) - base
+        )), ...);
+
+        return hasher.value();
+    }
+
+    /** Hashes the options that affect the records loaded from a file. */
+    inline
+    std::uint64_t options_hash(tsv::options const& opts)
+    {
+        detail::hasher hasher;
+        hasher.add(std::uint64_t(static_cast<unsigned char>(opts.delimiter)));
+        hasher.add(std::uint64_t(opts.header));
+        hasher.add(std::uint64_t(static_cast<unsigned char>(opts.comment)));
+        hasher.add(std::uint64_t(opts.on_error));
+        hasher.add(std::uint64_t(opts.escaping));
+
+        hasher.add(std::uint64_t(opts.columns.size()));
+        for (auto const column : opts.columns) {
+            hasher.add(std::uint64_t(column));
+        }
+
+        hasher.add(std::uint64_t(opts.column_names.size()));
+        for (auto const& name : opts.column_names) {
+            hasher.add(name);
+        }
+
+        return hasher.value();
+    }
+
+    /** Header of a cache file, followed by the saved records. */
+    struct cache_header
+    {
+        char magic[8] = {'T', 'S', 'V', 'C', 'A', 'C', 'H', 'E'};
+        std::uint32_t version = 3;
+        std::uint32_t byte_order = 0x01020304;
+        std::uint64_t source_size = 0;
+        std::int64_t source_time = 0;
+        std::uint64_t layout = 0;
+        std::uint64_t settings = 0;
+        std::uint64_t count = 0;
+        std::uint64_t data_size = 0;
+
+        /** Checks if two headers describe caches of the same source. */
+        bool matches(detail::cache_header const& other) const
+        {
+            return std::memcmp(magic, other.magic, sizeof magic) == 0 &&
+                version == other.version &&
+                byte_order == other.byte_order &&
+                source_size == other.source_size &&
+                source_time == other.source_time &&
+                layout == other.layout &&
+                settings == other.settings;
+        }
+    };
+
+    /**
+     * Makes the header expected for the cache of a file. Returns nullopt if
+     * the file cannot be inspected.
+     */
+    template<typename Record>
+    std::optional<detail::cache_header> make_cache_header(
+        std::filesystem::path const& path, tsv::options const& opts
+    )
+    {
+        std::error_code ec;
+        auto const size = std::filesystem::file_size(path, ec);
+        if (ec) {
+            return std::nullopt;
+        }
+        auto const time = std::filesystem::last_write_time(path, ec);
+        if (ec) {
+            return std::nullopt;
+        }
+
+        detail::cache_header header;
+        header.source_size = size;
+        header.source_time = static_cast<std::int64_t>(time.time_since_epoch().count());
+        header.layout = detail::layout_hash<Record>(
+            detail::field_type_list<Record>{},
+            std::make_index_sequence<detail::record_size_v<Record>>{}
+        );
+        header.settings = detail::options_hash(opts);
+        return header;
+    }
+
+    /** Appends the fields of a record to a buffer. Strings are length-prefixed. */
+    template<typename Record, typename... Ts, std::size_t... Is>
+    void save_fields(
+        Record const& record,
+        std::string& out,
+        detail::type_list<Ts...>,
+        std::index_sequence<Is...>
+    )
+    {
+        [[maybe_unused]] auto const fields = detail::tie_fields(record);
+
+        auto const save = [&](auto const& value) {
+            using type = std::decay_t<decltype(value)>;
+            if constexpr (std::is_same_v<type, std::string>) {
+                std::uint64_t const size = value.size();
+                out.append(reinterpret_cast<char const*>(&size), sizeof size);
+                out += value;
+            } else {
+                out.append(reinterpret_cast<char const*>(&value), sizeof value);
+            }
+        };
+        (save(std::get<Is>(fields)), ...);
+    }
+
+    /**
+     * Reads the fields of a record saved by `save_fields`. Returns false if
+     * the data is truncated or a boolean is neither 0 nor 1. Class-type
+     * fields are restored byte for byte as they were saved.
+     */
+    template<typename Record, typename... Ts, std::size_t... Is>
+    bool load_fields(
+        std::string_view& data,
+        Record& record,
+        detail::type_list<Ts...>,
+        std::index_sequence<Is...>
+    )
+    {
+        auto const read = [&](void* dest, std::size_t size) {
+            if (data.size() < size) {
+                return false;
+            }
+            std::memcpy(dest, data.data(), size);
+            data.remove_prefix(size);
+            return true;
+        };
+
+        auto const load = [&](auto& value) {
+            using type = std::decay_t<decltype(value)>;
+            if constexpr (std::is_same_v<type, std::string>) {
+                std::uint64_t size;
+                if (!read(&size, sizeof size) || data.size() < size) {
+                    return false;
+                }
+                value.assign(data.data(), static_cast<std::size_t>(size));
+                data.remove_prefix(static_cast<std::size_t>(size));
+                return true;
+            } else if constexpr (std::is_same_v<type, bool>) {
+                static_assert(sizeof(bool) == 1, "bool must be saved as a byte");
+                unsigned char byte;
+                if (!read(&byte, sizeof byte) || byte > 1) {
+                    return false;
+                }
+                value = byte != 0;
+                return true;
+            } else if constexpr (std::is_enum_v<type>) {
+                std::underlying_type_t<type> raw;
+                if (!read(&raw, sizeof raw)) {
+                    return false;
+                }
+                value = static_cast<type>(raw);
+                return true;
+            } else {
+                return read(&value, sizeof value);
+            }
+        };
+
+        [[maybe_unused]] auto const fields = detail::tie_fields(record);
+        return (load(std::get<Is>(fields)) && ...);
+    }
+
+    /** Reads the records in a cache. Returns nullopt if the cache is stale. */
+    template<typename Record>
+    std::optional<std::vector<Record>> read_cache(
+        std::filesystem::path const& path, detail::cache_header const& expected
+    )
+    {
+        std::error_code ec;
+        if (!std::filesystem::is_regular_file(path, ec)) {
+            return std::nullopt;
+        }
+
+        std::optional<detail::mapped_file> file;
+        try {
+            file.emplace(path);
+        } catch (tsv::io_error const&) {
+            return std::nullopt;
+        }
+
+        auto data = file->view();
+
+        detail::cache_header header;
+        if (data.size() < sizeof header) {
+            return std::nullopt;
+        }
+        std::memcpy(&header, data.data(), sizeof header);
+        data.remove_prefix(sizeof header);
+
+        if (!header.matches(expected) || header.data_size != data.size()) {
+            return std::nullopt;
+        }
+
+        auto const count = static_cast<std::size_t>(header.count);
+
+        if constexpr (detail::is_raw_cacheable_v<Record>) {
+            if (header.data_size / sizeof(Record) != count ||
+                header.data_size % sizeof(Record) != 0) {
+                return std::nullopt;
+            }
+            std::vector<Record> records(count);
+            std::memcpy(static_cast<void*>(records.data()), data.data(), data.size());
+            return records;
+        } else {
+            // Each record takes at least a byte, so a larger count comes from
+            // a corrupt header and must not size the allocation.
+            if (header.count > header.data_size) {
+                return std::nullopt;
+            }
+
+            std::vector<Record> records(count);
+            for (auto& record : records) {
+                if (!detail::load_fields(
+                    data,
+                    record,
+                    detail::field_type_list<Record>{},
+                    std::make_index_sequence<detail::record_size_v<Record>>{}
+                )) {
+                    return std::nullopt;
+                }
+            }
+            if (!data.empty()) {
+                return std::nullopt;
+            }
+            return records;
+        }
+    }
+
+    /**
+     * Saves records to a cache. The cache is written to a temporary file
+     * and renamed, so a reader never sees a partial cache. Failures are
+     * ignored since the cache is only an optimization.
+     */
+    template<typename Record>
+    void write_cache(
+        std::filesystem::path const& path,
+        detail::cache_header header,
+        std::vector<Record> const& records
+    )
+    {
+        constexpr std::size_t block_size = std::size_t(1) << 20;
+
+        auto temp_path = path;
+        temp_path += ".tmp";
+        temp_path += std::to_string(
+            std::hash<std::thread::id>{}(std::this_thread::get_id()) ^
+            static_cast<std::size_t>(
+                std::chrono::steady_clock::now().time_since_epoch().count()
+            )
+        );
+
+        try {
+            std::ofstream file{temp_path, std::ios::binary | std::ios::trunc};
+
+            header.count = records.size();
+
+            if constexpr (detail::is_raw_cacheable_v<Record>) {
+                header.data_size = records.size() * sizeof(Record);
+                file.write(reinterpret_cast<char const*>(&header), sizeof header);
+                file.write(
+                    reinterpret_cast<char const*>(records.data()),
+                    static_cast<std::streamsize>(header.data_size)
+                );
+            } else {
+                // Write the records after a placeholder of the header.
+                file.write(reinterpret_cast<char const*>(&header), sizeof header);
+
+                std::string buffer;
+                for (auto const& record : records) {
+                    detail::save_fields(
+                        record,
+                        buffer,
+                        detail::field_type_list<Record>{},
+                        std::make_index_sequence<detail::record_size_v<Record>>{}
+                    );
+                    if (buffer.size() >= block_size) {
+                        header.data_size += buffer.size();
+                        file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+                        buffer.clear();
+                    }
+                }
+                header.data_size += buffer.size();
+                file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+
+                file.seekp(0);
+                file.write(reinterpret_cast<char const*>(&header), sizeof header);
+            }
+
+            file.close();
+            if (!file) {
+                throw tsv::io_error{tsv::io_error::unknown};
+            }
+
+            std::filesystem::rename(temp_path, path);
+        } catch (...) {
+            std::error_code ec;
+            std::filesystem::remove(temp_path, ec);
+        }
+    }
+}
+
+// VALIDATION ----------------------------------------------------------------
+
+namespace tsv::detail
+{
+    /** Validates the values assigned to the fields of a record. */
+    template<
+        typename Record,
+        typename = decltype(std::declval<Record const&>().validate())
+    >
+    void validate(Record const& record)
+    {
+        record.validate();
+    }
+
+    template<typename Record, typename... Dummy>
+    void validate(Record const&, Dummy...)
+    {
+    }
+
+    /** Traits for detecting the `validate()` member function. */
+    template<typename Record, typename = void>
+    struct has_validate : std::false_type {};
+
+    template<typename Record>
+    struct has_validate<
+        Record,
+        std::void_t<decltype(std::declval<Record const&>().validate())>
+    > : std::true_type {};
+
+    template<typename Record>
+    inline constexpr bool has_validate_v = detail::has_validate<Record>::value;
+
+    /**
+     * Traits for detecting the static `validate_batch(tsv::span<Record const>)`
+     * member function, which returns the number of leading records that
+     * are valid.
+     */
+    template<typename Record, typename = void>
+    struct has_validate_batch : std::false_type {};
+
+    template<typename Record>
+    struct has_validate_batch<
+        Record,
+        std::enable_if_t<
+            std::is_convertible_v<
+                decltype(Record::validate_batch(std::declval<tsv::span<Record const>>())),
+                std::size_t
+            >
+        >
+    > : std::true_type {};
+
+    template<typename Record>
+    inline constexpr bool has_validate_batch_v = detail::has_validate_batch<Record>::value;
+
+    /**
+     * Validates a block of records with the `validate_batch` function of the
+     * record type. Returns the number of leading records that are valid,
+     * which is the size of the block if all records are valid.
+     */
+    template<typename Record>
+    std::size_t validate_batch(tsv::span<Record const> records)
+    {
+        if constexpr (detail::has_validate_batch_v<Record>) {
+            return std::min(std::size_t(Record::validate_batch(records)), records.size());
+        } else {
+            return records.size();
+        }
+    }
+
+    /**
+     * Validates a single record with both of the `validate()` and the
+     * `validate_batch` functions, if defined.
+     */
+    template<typename Record>
+    void validate_one(Record const& record)
+    {
+        detail::validate(record);
+
+        if constexpr (detail::has_validate_batch_v<Record>) {
+            if (detail::validate_batch(tsv::span<Record const>{&record, 1}) == 0) {
+                throw tsv::validation_error{tsv::validation_error::invalid_record};
+            }
+        }
+    }
+}
+
+// READER --------------------------------------------------------------------
+
+namespace tsv
+{
+    /**
+     * Input range of records incrementally parsed from a stream. Records are
+     * parsed one at a time as the range is iterated, so memory usage does not
+     * depend on the size of the input.
+     *
+     * ```
+     * std::ifstream file{"data.tsv"};
+     * tsv::reader<my_record> reader{file};
+     *
+     * for (auto& record : reader) {
+     *     ...
+     * }
+     * ```
+     *
+     * The reader keeps a reference to the input stream. The stream must
+     * outlive the reader.
+     *
+     * Source is the class used to read lines from the input. Use the
+     * `tsv::reader` and `tsv::file_reader` aliases instead of this class.
+     */
+    template<typename Record, typename Source>
+    class basic_reader
+    {
+    public:
+        class iterator;
+
+        /** Number of rows read at once by `read_all`. */
+        static constexpr std::size_t default_block_rows = 1024;
+
+        /**
+         * Constructs a reader. The header line, if enabled in the options, is
+         * read in the constructor.
+         *
+         * @param input is a stream (or a file path for `tsv::file_reader`)
+         *   containing a tab-separated document.
+         * @param opts control how the parser behaves.
+         */
+        template<typename Input>
+        explicit basic_reader(Input&& input, tsv::options const& opts = {})
+            : basic_reader{
+                std::forward<Input>(input), opts, detail::make_context(opts)
+            }
+        {
+        }
+
+        /**
+         * Constructs a reader with a custom parse context. The dictionary and
+         * stats options are ignored; the ones in the context are used instead.
+         */
+        template<typename Input>
+        basic_reader(
+            Input&& input, tsv::options const& opts, detail::parse_context context
+        )
+            : _parser{
+                detail::source_input<Source>(std::forward<Input>(input), opts),
+                opts.delimiter,
+                context
+            }
+            , _comment{opts.comment}
+            , _policy{opts.on_error}
+            , _errors{opts.rejected}
+            , _progress{opts.progress}
+            , _progress_interval{std::max(opts.progress_interval, std::size_t(1))}
+        {
+            if (detail::has_interned_field_v<Record> && !context.dictionary) {
+                throw std::invalid_argument{
+                    "dictionary is required for interned fields"
+                };
+            }
+
+            if (_policy == tsv::error_policy::collect && !_errors) {
+                throw std::invalid_argument{
+                    "rejected vector is required for the collect policy"
+                };
+            }
+
+            if (_progress && !context.stats) {
+                throw std::invalid_argument{
+                    "stats object is required for the progress function"
+                };
+            }
+
+            if (detail::has_view_field_v<Record> && context.escaping != tsv::escaping::none) {
+                throw std::invalid_argument{
+                    "string_view fields cannot refer to unescaped text"
+                };
+            }
+
+            static_assert(
+                !(detail::has_view_field_v<Record> &&
+                  std::is_same_v<std::remove_reference_t<Source>, detail::line_reader>),
+                "string_view fields cannot refer to a stream input; "
+                "use tsv::load_document or tsv::document"
+            );
+
+            _parser.skip_comment(_comment);
+
+            if (opts.header) {
+                if (!_parser.parse_fields(_header)) {
+                    throw tsv::format_error{tsv::format_error::missing_header};
+                }
+            }
+
+            auto const columns = detail::bind_columns(opts, _header);
+            if (!columns.empty()) {
+                _projection = detail::projection{
+                    columns, detail::record_size_v<Record>
+                };
+            }
+
+            if (!opts.filters.empty()) {
+                _parser.set_filters(opts.filters);
+            }
+        }
+
+        basic_reader(basic_reader const&) = delete;
+        basic_reader& operator=(basic_reader const&) = delete;
+
+        /**
+         * Returns the fields in the header line. Returns an empty vector if
+         * the header is disabled in the options.
+         */
+        std::vector<std::string> const& header() const
+        {
+            return _header;
+        }
+
+        /**
+         * Reads the next record. Returns true on success or false on reaching
+         * EOF. The record is validated before returning. Rows that fail are
+         * skipped unless the error policy is raise.
+         */
+        bool read(Record& record)
+        {
+            return read_row([&] {
+                auto const status = _parser.try_parse_record(record, _projection);
+                if (status && !status->failed()) {
+                    detail::phase_timer const timer{detail::phase_counter(
+                        _parser.context().stats, &tsv::load_stats::validate_time
+                    )};
+                    detail::validate_one(record);
+                }
+                return status;
+            });
+        }
+
+        /**
+         * Reads up to `max_rows` rows and appends the records to a vector.
+         * Rejected and filtered rows count towards `max_rows`. If the record type has a
+         * static `validate_batch` function, the function is called once on
+         * the whole block instead of once per record. Returns false on
+         * reaching EOF.
+         */
+        bool read_block(std::vector<Record>& records, std::size_t max_rows)
+        {
+            auto const first = records.size();
+            auto const rejected = _rejected;
+            auto const filtered = _parser.filtered();
+            auto const consumed = [&] {
+                return records.size() - first +
+                    _rejected - rejected +
+                    _parser.filtered() - filtered;
+            };
+
+            Record record;
+
+            if constexpr (!detail::has_validate_batch_v<Record>) {
+                while (consumed() < max_rows) {
+                    if (!read(record)) {
+                        return false;
+                    }
+                    records.push_back(std::move(record));
+                }
+                return true;
+            } else {
+                _block_lines.clear();
+                _block_text.clear();
+
+                auto const errors_before = _errors ? _errors->size() : 0;
+
+                bool more = true;
+                try {
+                    while (consumed() < max_rows) {
+                        more = read_row([&] {
+                            auto const status = _parser.try_parse_record(record, _projection);
+                            if (status && !status->failed()) {
+                                detail::phase_timer const timer{detail::phase_counter(
+                                    _parser.context().stats, &tsv::load_stats::validate_time
+                                )};
+                                detail::validate(record);
+                            }
+                            return status;
+                        });
+                        if (!more) {
+                            break;
+                        }
+                        records.push_back(std::move(record));
+
+                        auto const line = _parser.line();
+                        _block_lines.push_back({
+                            _parser.line_number(), _block_text.size(), line.size()
+                        });
+                        _block_text += line;
+                    }
+                } catch (...) {
+                    // An invalid record before the failed line is reported
+                    // first.
+                    validate_block(records, first, errors_before);
+                    throw;
+                }
+
+                validate_block(records, first, errors_before);
+                return more;
+            }
+        }
+
+        /** Reads all remaining records and appends them to a vector. */
+        void read_all(std::vector<Record>& records)
+        {
+            while (read_block(records, default_block_rows)) {
+            }
+        }
+
+        /**
+         * Reads the next row without constructing a record. The texts of the
+         * record fields are passed to `visit` as a `std::string_view const*`
+         * pointing to an array. The texts are valid only during the call.
+         * `visit` may return a `detail::parse_status` to reject the row.
+         * Returns true on success or false on reaching EOF.
+         */
+        template<typename Visit>
+        bool read_fields(Visit const& visit)
+        {
+            constexpr auto field_count = detail::record_size_v<Record>;
+            return read_row([&] {
+                return _parser.template try_parse_texts<field_count>(_projection, visit);
+            });
+        }
+
+        /**
+         * Returns the number of rows rejected so far under the skip or collect
+         * error policy.
+         */
+        std::size_t rejected() const
+        {
+            return _rejected;
+        }
+
+        /** Returns the number of rows skipped by the filters so far. */
+        std::size_t filtered() const
+        {
+            return _parser.filtered();
+        }
+
+        /** Returns the context passed to field conversions. */
+        detail::parse_context const& context() const
+        {
+            return _parser.context();
+        }
+
+        /** Starts iteration by reading the first record. */
+        iterator begin()
+        {
+            return iterator{*this};
+        }
+
+        /** Returns the past-the-end iterator. */
+        iterator end()
+        {
+            return iterator{};
+        }
+
+    private:
+        /**
+         * Calls `parse()` on the next non-comment row and applies the error
+         * policy to the returned status. Under the raise policy, failures are
+         * thrown. Under the other policies, failed rows and the rows that throw
+         * `tsv::error` are rejected and the next row is tried.
+         */
+        template<typename Parse>
+        bool read_row(Parse const& parse)
+        {
+            for (;;) {
+                _parser.skip_comment(_comment);
+
+                if (_policy == tsv::error_policy::raise) {
+                    auto const status = parse();
+                    if (status && status->failed()) {
+                        detail::raise(*status, _parser.line(), _parser.line_number());
+                    }
+                    return count_row(bool(status));
+                }
+
+                try {
+                    auto const status = parse();
+                    if (!status) {
+                        return count_row(false);
+                    }
+                    if (!status->failed()) {
+                        return count_row(true);
+                    }
+                    reject(tsv::error{status->message});
+                } catch (tsv::io_error const&) {
+                    throw;
+                } catch (tsv::error const& err) {
+                    reject(err);
+                }
+            }
+        }
+
+        /** Counts a rejected row and records its error if collecting. */
+        void reject(tsv::error const& err)
+        {
+            _rejected++;
+
+            if (auto const stats = _parser.context().stats) {
+                stats->rejected_rows++;
+            }
+
+            if (_policy == tsv::error_policy::collect) {
+                _errors->push_back(err);
+
+                auto& saved = _errors->back();
+                if (!saved.line_number) {
+                    saved.line = _parser.line();
+                    saved.line_number = _parser.line_number();
+                }
+            }
+        }
+
+        /**
+         * Applies `validate_batch` to the records read into a vector from
+         * index `first`, and applies the error policy to the invalid ones.
+         * After rejecting a record, the following records are validated
+         * again. `_block_lines` locates the lines of the records in
+         * `_block_text`. The collected errors are merged in the line order
+         * with those of the rows rejected while parsing the block, which
+         * start at index `errors_before`.
+         */
+        void validate_block(
+            std::vector<Record>& records, std::size_t first, std::size_t errors_before
+        )
+        {
+            auto const stats = _parser.context().stats;
+            auto const end = records.size();
+            auto read = first;
+            auto write = first;
+
+            std::vector<tsv::error> invalid;
+
+            // Valid records are moved down over the rejected ones in one pass.
+            auto const keep = [&](std::size_t count) {
+                for (; count > 0; count--, read++, write++) {
+                    if (write != read) {
+                        records[write] = std::move(records[read]);
+                        _block_lines[write - first] = _block_lines[read - first];
+                    }
+                }
+            };
+
+            while (read < end) {
+                std::size_t valid;
+                {
+                    detail::phase_timer const timer{
+                        detail::phase_counter(stats, &tsv::load_stats::validate_time)
+                    };
+                    valid = detail::validate_batch(
+                        tsv::span<Record const>{records.data() + read, end - read}
+                    );
+                }
+                keep(valid);
+                if (read == end) {
+                    break;
+                }
+
+                auto const& line = _block_lines[read - first];
+                tsv::validation_error err{tsv::validation_error::invalid_record};
+                err.line = _block_text.substr(line.offset, line.size);
+                err.line_number = line.number;
+
+                if (_policy == tsv::error_policy::raise) {
+                    records.erase(
+                        records.begin() + static_cast<std::ptrdiff_t>(write), records.end()
+                    );
+                    throw err;
+                }
+
+                _rejected++;
+                if (stats) {
+                    stats->rows--;
+                    stats->rejected_rows++;
+                }
+                if (_policy == tsv::error_policy::collect) {
+                    invalid.push_back(std::move(err));
+                }
+                read++;
+            }
+
+            records.erase(records.begin() + static_cast<std::ptrdiff_t>(write), records.end());
+            _block_lines.resize(write - first);
+
+            if (!invalid.empty()) {
+                auto& errors = *_errors;
+                auto const middle = static_cast<std::ptrdiff_t>(errors.size());
+                std::move(invalid.begin(), invalid.end(), std::back_inserter(errors));
+                std::inplace_merge(
+                    errors.begin() + static_cast<std::ptrdiff_t>(errors_before),
+                    errors.begin() + middle,
+                    errors.end(),
+                    [](tsv::error const& lhs, tsv::error const& rhs) {
+                        return lhs.line_number < rhs.line_number;
+                    }
+                );
+            }
+        }
+
+        /**
+         * Counts a loaded row, or reports the end of the input if `loaded` is
+         * false, and calls the progress function when due. Returns `loaded`.
+         */
+        bool count_row(bool loaded)
+        {
+            auto const stats = _parser.context().stats;
+            if (!stats) {
+                return loaded;
+            }
+
+            if (loaded) {
+                stats->rows++;
+                if (_progress && ++_pending_rows >= _progress_interval) {
+                    _pending_rows = 0;
+                    _progress(*stats);
+                }
+            } else if (_progress && !_finished) {
+                _finished = true;
+                _progress(*stats);
+            }
+            return loaded;
+        }
+
+    private:
+        detail::basic_parser<Source> _parser;
+        char const _comment;
+        tsv::error_policy const _policy;
+        std::vector<tsv::error>* const _errors;
+        std::function<void(tsv::load_stats const&)> const _progress;
+        std::size_t const _progress_interval;
+        std::size_t _pending_rows = 0;
+        bool _finished = false;
+        std::size_t _rejected = 0;
+        detail::projection _projection;
+        std::vector<std::string> _header;
+        /** Location of the line of a record in a block. */
+        struct block_line
+        {
+            std::size_t number;
+            std::size_t offset;
+            std::size_t size;
+        };
+
+        std::vector<block_line> _block_lines;
+        std::string _block_text;
+    };
+
+    /**
+     * Single-pass input iterator of tsv::basic_reader. The iterator owns the
+     * current record, so dereferencing yields a mutable reference that can be
+     * moved from.
+     */
+    template<typename Record, typename Source>
+    class basic_reader<Record, Source>::iterator
+    {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = Record;
+        using difference_type = std::ptrdiff_t;
+        using pointer = Record*;
+        using reference = Record&;
+
+        /** Constructs a past-the-end iterator. */
+        iterator() = default;
+
+        explicit iterator(basic_reader& source)
+            : _source{&source}
+        {
+            ++*this;
+        }
+
+        Record& operator*()
+        {
+            return _record;
+        }
+
+        Record* operator->()
+        {
+            return &_record;
+        }
+
+        iterator& operator++()
+        {
+            if (!_source->read(_record)) {
+                _source = nullptr;
+            }
+            return *this;
+        }
+
+        void operator++(int)
+        {
+            ++*this;
+        }
+
+        bool operator==(iterator const& other) const
+        {
+            return _source == other._source;
+        }
+
+        bool operator!=(iterator const& other) const
+        {
+            return !(*this == other);
+        }
+
+    private:
+        basic_reader* _source = nullptr;
+        Record _record;
+    };
+
+    /** Reader of records from a stream. */
+    template<typename Record>
+    using reader = tsv::basic_reader<Record, detail::line_reader>;
+
+    /**
+     * Reader of records from a file. The file is memory-mapped if possible
+     * and lines are parsed without being copied.
+     */
+    template<typename Record>
+    using file_reader = tsv::basic_reader<Record, detail::file_line_reader>;
+}
+
+namespace tsv::detail
+{
+    /**
+     * Estimates the number of lines in a text from the average length of the
+     * lines in the first block of the text.
+     */
+    inline
+    std::size_t estimate_lines(std::string_view text)
+    {
+        constexpr std::size_t sample_size = std::size_t(1) << 16;
+
+        auto const sample = text.substr(0, sample_size);
+        auto const lines = static_cast<std::size_t>(
+            std::count(sample.begin(), sample.end(), '\n')
+        );
+
+        if (sample.empty()) {
+            return 0;
+        }
+        return lines * (text.size() / sample.size()) +
+            lines * (text.size() % sample.size()) / sample.size() + 1;
+    }
+
+    /**
+     * Appends the records read from a line source to a vector. The header,
+     * if enabled and not needed for binding columns, is skipped without
+     * being split into fields. The skipped lines are counted in the stats as
+     * in `tsv::load`. Nothing is allocated except for the records and the
+     * fields of the records.
+     */
+    template<typename Record, typename Source>
+    void read_into(
+        std::vector<Record>& records, Source& source, tsv::options const& opts
+    )
+    {
+        tsv::basic_reader<Record, Source&> reader = [&] {
+            if (!opts.header || !opts.column_names.empty()) {
+                return tsv::basic_reader<Record, Source&>{source, opts};
+            }
+
+            detail::basic_parser<Source&> prologue{
+                source, opts.delimiter, detail::make_context(opts)
+            };
+            prologue.skip_comment(opts.comment);
+            if (!prologue.read_line()) {
+                throw tsv::format_error{tsv::format_error::missing_header};
+            }
+
+            auto body_opts = opts;
+            body_opts.header = false;
+            return tsv::basic_reader<Record, Source&>{source, body_opts};
+        }();
+
+        reader.read_all(records);
+    }
+}
+
+namespace tsv
+{
+    template<typename Record>
+    std::vector<Record> load(std::istream& input, tsv::options const& opts)
+    {
+        std::vector<Record> records;
+        tsv::reader<Record>{input, opts}.read_all(records);
+        return records;
+    }
+
+    template<typename Record>
+    std::vector<Record> load_file(
+        std::filesystem::path const& path, tsv::options const& opts
+    )
+    {
+        static_assert(
+            !detail::has_view_field_v<Record>,
+            "string_view fields would outlive the file; "
+            "use tsv::load_file_document or tsv::document"
+        );
+
+        // Errors are not saved in the cache, so collecting bypasses it.
+        // Filters cannot be compared with those of the cached load.
+        bool const cached = !opts.cache.empty() &&
+            opts.on_error != tsv::error_policy::collect &&
+            opts.filters.empty();
+
+        if (cached) {
+            if constexpr (detail::is_cacheable_v<Record>) {
+                auto const header = detail::make_cache_header<Record>(path, opts);
+                if (header) {
+                    if (auto records = detail::read_cache<Record>(opts.cache, *header)) {
+                        // Only the rows are counted since nothing is parsed.
+                        if (opts.stats) {
+                            opts.stats->rows += records->size();
+                            if (opts.progress) {
+                                opts.progress(*opts.stats);
+                            }
+                        }
+                        return std::move(*records);
+                    }
+                }
+
+                auto parse_opts = opts;
+                parse_opts.cache.clear();
+                auto records = tsv::load_file<Record>(path, parse_opts);
+
+                if (header) {
+                    detail::write_cache(opts.cache, *header, records);
+                }
+                return records;
+            } else {
+                throw std::invalid_argument{"record type cannot be cached"};
+            }
+        }
+
+        std::vector<Record> records;
+        tsv::file_reader<Record>{path, opts}.read_all(records);
+        return records;
+    }
+
+    /**
+     * Loads tab-separated values into an existing vector. The vector is
+     * cleared first, and its capacity is reused. Use this function to reload
+     * inputs of the same shape repeatedly without reallocating the vector.
+     *
+     * @param records is the vector receiving the loaded records.
+     * @param input is a stream containing a tab-separated document.
+     * @param opts control how the parser behaves.
+     */
+    template<typename Record>
+    void load_into(
+        std::vector<Record>& records,
+        std::istream& input,
+        tsv::options const& opts = {}
+    )
+    {
+        records.clear();
+
+        detail::line_reader source{
+            input, detail::line_reader::default_block_size, opts.read_ahead
+        };
+        detail::read_into(records, source, opts);
+    }
+
+    template<typename Record>
+    void load_into(
+        std::vector<Record>& records,
+        std::istream&& input,
+        tsv::options const& opts = {}
+    )
+    {
+        tsv::load_into(records, input, opts);
+    }
+
+    /**
+     * Loads tab-separated values from a file into an existing vector. The
+     * vector is cleared first, and its capacity is reused. The vector is
+     * reserved for the number of rows estimated from the file size. If the
+     * file is memory-mapped, reloading a file of the same shape allocates
+     * nothing for records without dynamically-sized fields.
+     *
+     * @param records is the vector receiving the loaded records.
+     * @param path is the path of a file containing a tab-separated document.
+     * @param opts control how the parser behaves.
+     */
+    template<typename Record>
+    void load_file_into(
+        std::vector<Record>& records,
+        std::filesystem::path const& path,
+        tsv::options const& opts = {}
+    )
+    {
+        static_assert(
+            !detail::has_view_field_v<Record>,
+            "string_view fields would outlive the file; "
+            "use tsv::load_file_document or tsv::document"
+        );
+
+        records.clear();
+
+        detail::mapped_file const file{path};
+        records.reserve(detail::estimate_lines(file.view()));
+
+        detail::memory_reader source{file.view()};
+        detail::read_into(records, source, opts);
+    }
+}
+
+// ROW VIEWS -----------------------------------------------------------------
+
+namespace tsv
+{
+    /**
+     * Lazy view of a row. The fields are located only when accessed, and
+     * only up to the accessed field, and converted only when requested. Use
+     * this to filter rows on a few fields before materializing records.
+     * The view refers to the line, so it is valid only until the next line
+     * is read.
+     */
+    class row
+    {
+    public:
+        /** Constructs a view of an empty line. */
+        row() = default;
+
+        /** Constructs a view of a line. */
+        explicit row(std::string_view line, char delim = '\t')
+            : _delim{delim}
+        {
+            assign(line, 0);
+        }
+
+        /**
+         * Constructs a view of an empty line with the settings of a reader.
+         * The projection, if not null, is used by `parse` and must outlive
+         * the view.
+         */
+        row(
+            char delim,
+            detail::parse_context const& context,
+            detail::projection const* projection,
+            std::size_t projected_fields
+        )
+            : _delim{delim}
+            , _context{context}
+            , _projection{projection}
+            , _projected_fields{projected_fields}
+        {
+        }
+
+        /**
+         * Points the view to another line. The field table is reused. A line
+         * with escapes is split and unescaped at once.
+         */
+        void assign(std::string_view line, std::size_t line_number)
+        {
+            _line = line;
+            _line_number = line_number;
+            _fields.clear();
+
+            if (detail::needs_unescape(line, _context)) {
+                _splitter.reset();
+                detail::escaped_splitter splitter{line, _delim, _scratch};
+                while (!splitter.done()) {
+                    _fields.push_back(splitter.next());
+                }
+            } else {
+                _splitter.emplace(line, _delim);
+            }
+        }
+
+        /** Returns the content of the line. */
+        std::string_view line() const
+        {
+            return _line;
+        }
+
+        /** Returns the 1-based line number, or zero if not known. */
+        std::size_t line_number() const
+        {
+            return _line_number;
+        }
+
+        /** Returns the number of fields. This scans the whole line. */
+        std::size_t size() const
+        {
+            scan(std::size_t(-1));
+            return _fields.size();
+        }
+
+        /**
+         * Returns the text of the i-th field. Throws `tsv::format_error` if
+         * the row has fewer fields.
+         */
+        std::string_view field(std::size_t i) const
+        {
+            scan(i + 1);
+            if (i >= _fields.size()) {
+                throw detail::annotate(
+                    tsv::format_error{tsv::format_error::missing_field},
+                    _line,
+                    _line_number
+                );
+            }
+            return _fields[i];
+        }
+
+        /** Parses the i-th field as a value of type T. */
+        template<typename T>
+        T get(std::size_t i) const
+        {
+            if constexpr (detail::is_interned<T>::value) {
+                check_dictionary();
+            }
+
+            auto const text = field(i);
+            try {
+                detail::parse_status status;
+                auto value = detail::parse_field<T>(text, _context, status);
+                if (status.failed()) {
+                    detail::raise(status, _line, _line_number);
+                }
+                return value;
+            } catch (tsv::error& err) {
+                if (!err.line_number) {
+                    err.line = _line;
+                    err.line_number = _line_number;
+                }
+                throw;
+            }
+        }
+
+        /**
+         * Parses the row as a record, taking the columns selected in the
+         * reader options if any. The record is validated before returning.
+         */
+        template<typename Record>
+        Record parse() const
+        {
+            if constexpr (detail::has_interned_field_v<Record>) {
+                check_dictionary();
+            }
+
+            Record record;
+            detail::field_type_list<Record> field_types;
+            try {
+                detail::parse_status status;
+                auto const& projection = _projection ? *_projection : detail::projection{};
+
+                if (!projection.empty() && _projected_fields != detail::record_size_v<Record>) {
+                    throw std::invalid_argument{
+                        "number of columns does not match number of fields"
+                    };
+                }
+
+                if (detail::needs_unescape(_line, _context)) {
+                    // The field table refers to the other buffer.
+                    status = detail::try_parse_escaped(
+                        _line, _delim, projection, field_types, _context, record, _parse_scratch
+                    );
+                } else if (!projection.empty()) {
+                    status = detail::try_parse_projected(
+                        _line, _delim, projection, field_types, _context, record
+                    );
+                } else {
+                    status = detail::try_parse_record(
+                        _line, _delim, field_types, _context, record
+                    );
+                }
+                if (status.failed()) {
+                    detail::raise(status, _line, _line_number);
+                }
+                detail::validate_one(record);
+            } catch (tsv::error& err) {
+                if (!err.line_number) {
+                    err.line = _line;
+                    err.line_number = _line_number;
+                }
+                throw;
+            }
+            return record;
+        }
+
+    private:
+        /** Locates the fields up to the `count`-th one, if not yet. */
+        void scan(std::size_t count) const
+        {
+            if (!_splitter) {
+                return;
+            }
+            while (_fields.size() < count && !_splitter->done()) {
+                _fields.push_back(_splitter->next());
+            }
+        }
+
+        void check_dictionary() const
+        {
+            if (!_context.dictionary) {
+                throw std::invalid_argument{
+                    "dictionary is required for interned fields"
+                };
+            }
+        }
+
+    private:
+        std::string_view _line;
+        std::size_t _line_number = 0;
+        char _delim = '\t';
+        detail::parse_context _context;
+        detail::projection const* _projection = nullptr;
+        std::size_t _projected_fields = 0;
+        mutable std::vector<std::string_view> _fields;
+        mutable std::optional<detail::field_splitter> _splitter;
+        std::string _scratch;
+        mutable std::string _parse_scratch;
+    };
+
+    /**
+     * Class for reading lazy row views from a line source. Comment and empty
+     * lines and the header are skipped like `tsv::basic_reader`. Rows are
+     * not parsed by the reader, so the error policy does not apply; errors
+     * are thrown from the row view functions.
+     */
+    template<typename Source>
+    class basic_row_reader
+    {
+    public:
+        /**
+         * Constructs a reader. The header line, if enabled in the options, is
+         * read in the constructor.
+         *
+         * @param input is a stream (or a file path for `tsv::file_row_reader`)
+         *   containing a tab-separated document.
+         * @param opts control how the parser behaves.
+         */
+        template<typename Input>
+        explicit basic_row_reader(Input&& input, tsv::options const& opts = {})
+            : _parser{
+                detail::source_input<Source>(std::forward<Input>(input), opts),
+                opts.delimiter,
+                detail::make_context(opts)
+            }
+            , _comment{opts.comment}
+        {
+            _parser.skip_comment(_comment);
+
+            if (opts.header) {
+                if (!_parser.parse_fields(_header)) {
+                    throw tsv::format_error{tsv::format_error::missing_header};
+                }
+            }
+
+            auto const columns = detail::bind_columns(opts, _header);
+            if (!columns.empty()) {
+                _projection = detail::projection{columns, columns.size()};
+            }
+            _row = tsv::row{opts.delimiter, _parser.context(), &_projection, columns.size()};
+
+            if (!opts.filters.empty()) {
+                _parser.set_filters(opts.filters);
+            }
+        }
+
+        basic_row_reader(basic_row_reader const&) = delete;
+        basic_row_reader& operator=(basic_row_reader const&) = delete;
+
+        /**
+         * Returns the fields in the header line. Returns an empty vector if
+         * the header is disabled in the options.
+         */
+        std::vector<std::string> const& header() const
+        {
+            return _header;
+        }
+
+        /**
+         * Returns the index of a column in the header. Throws
+         * `tsv::format_error` if the header has no such column.
+         */
+        std::size_t column(std::string_view name) const
+        {
+            auto const pos = std::find(_header.begin(), _header.end(), name);
+            if (pos == _header.end()) {
+                throw tsv::format_error{tsv::format_error::missing_column};
+            }
+            return static_cast<std::size_t>(pos - _header.begin());
+        }
+
+        /**
+         * Reads the next row. Returns a view of the row, or null on reaching
+         * EOF. The view is owned by the reader and is valid until the next
+         * call.
+         */
+        tsv::row const* read()
+        {
+            _parser.skip_comment(_comment);
+
+            auto const line = _parser.read_line();
+            if (!line) {
+                return nullptr;
+            }
+            _row.assign(*line, _parser.line_number());
+
+            if (auto const stats = _parser.context().stats) {
+                stats->rows++;
+            }
+            return &_row;
+        }
+
+    private:
+        detail::basic_parser<Source> _parser;
+        char const _comment;
+        std::vector<std::string> _header;
+        detail::projection _projection;
+        tsv::row _row;
+    };
+
+    /** Reader of lazy row views from a stream. */
+    using row_reader = tsv::basic_row_reader<detail::line_reader>;
+
+    /** Reader of lazy row views from a memory-mapped file. */
+    using file_row_reader = tsv::basic_row_reader<detail::file_line_reader>;
+}
+
+// DOCUMENT ------------------------------------------------------------------
+
+namespace tsv
+{
+    /**
+     * Records loaded together with the text they are parsed from. Records in
+     * a document can have `std::string_view` fields referring to the text, so
+     * text fields are loaded without any per-field allocation.
+     *
+     * ```
+     * struct my_record
+     * {
+     *     std::string_view id;
+     *     double value;
+     * };
+     *
+     * tsv::document<my_record> doc{std::filesystem::path{"data.tsv"}};
+     *
+     * for (auto const& record : doc) {
+     *     ...
+     * }
+     * ```
+     *
+     * A file is memory-mapped and a stream is read into a single buffer. The
+     * views in the records are valid while the document is alive, including
+     * after the document is moved.
+     */
+    template<typename Record>
+    class document
+    {
+    public:
+        using const_iterator = typename std::vector<Record>::const_iterator;
+
+        /**
+         * Loads records from a stream.
+         *
+         * @param input is a stream containing a tab-separated document.
+         * @param opts control how the parser behaves.
+         */
+        explicit document(std::istream& input, tsv::options const& opts = {})
+            : _content{input}
+        {
+            load(opts);
+        }
+
+        /**
+         * Loads records from a file.
+         *
+         * @param path is the path of a file containing a tab-separated
+         *   document.
+         * @param opts control how the parser behaves.
+         */
+        explicit document(
+            std::filesystem::path const& path, tsv::options const& opts = {}
+        )
+            : _content{path}
+        {
+            load(opts);
+        }
+
+        /** Returns the text the records refer to. */
+        std::string_view text() const
+        {
+            return _content.view();
+        }
+
+        /** Returns the loaded records. */
+        std::vector<Record> const& records() const
+        {
+            return _records;
+        }
+
+        std::size_t size() const
+        {
+            return _records.size();
+        }
+
+        bool empty() const
+        {
+            return _records.empty();
+        }
+
+        Record const& operator[](std::size_t index) const
+        {
+            return _records[index];
+        }
+
+        const_iterator begin() const
+        {
+            return _records.begin();
+        }
+
+        const_iterator end() const
+        {
+            return _records.end();
+        }
+
+    private:
+        void load(tsv::options const& opts)
+        {
+            detail::memory_reader source{_content.view()};
+            tsv::basic_reader<Record, detail::memory_reader&> reader{source, opts};
+            reader.read_all(_records);
+        }
+
+    private:
+        detail::mapped_file _content;
+        std::vector<Record> _records;
+    };
+
+    /**
+     * Loads records from a stream into a document. See `tsv::document`.
+     *
+     * @param input is a stream containing a tab-separated document.
+     * @param opts control how the parser behaves.
+     */
+    template<typename Record>
+    tsv::document<Record> load_document(
+        std::istream& input, tsv::options const& opts = {}
+    )
+    {
+        return tsv::document<Record>{input, opts};
+    }
+
+    template<typename Record>
+    tsv::document<Record> load_document(
+        std::istream&& input, tsv::options const& opts = {}
+    )
+    {
+        return tsv::document<Record>{input, opts};
+    }
+
+    /**
+     * Loads records from a file into a document. See `tsv::document`.
+     *
+     * @param path is the path of a file containing a tab-separated document.
+     * @param opts control how the parser behaves.
+     */
+    template<typename Record>
+    tsv::document<Record> load_file_document(
+        std::filesystem::path const& path, tsv::options const& opts = {}
+    )
+    {
+        return tsv::document<Record>{path, opts};
+    }
+}
+
+// COLUMNAR LOADING ----------------------------------------------------------
+
+namespace tsv::detail
+{
+    template<typename FieldTypes>
+    struct column_tuple;
+
+    template<typename... Ts>
+    struct column_tuple<detail::type_list<Ts...>>
+    {
+        using type = std::tuple<std::vector<Ts>...>;
+    };
+
+    /**
+     * Reads all rows from a reader into the columns. The fields are parsed
+     * and appended directly to the column vectors. A temporary record is
+     * constructed only if the record type needs to be validated.
+     */
+    template<typename Record, typename Source, typename... Ts, std::size_t... Is>
+    void read_columns(
+        tsv::basic_reader<Record, Source>& reader,
+        std::tuple<std::vector<Ts>...>& columns,
+        std::index_sequence<Is...>
+    )
+    {
+        auto const& context = reader.context();
+        auto const visit = [&](std::string_view const* texts) {
+            detail::parse_status status;
+            std::tuple<Ts...> values{detail::parse_field<Ts>(texts[Is], context, status)...};
+
+            if (status.failed()) {
+                return status;
+            }
+
+            if constexpr (detail::has_validate_v<Record> || detail::has_validate_batch_v<Record>) {
+                Record const record{std::get<Is>(values)...};
+                detail::validate_one(record);
+            }
+
+            (std::get<Is>(columns).push_back(std::move(std::get<Is>(values))), ...);
+            return status;
+        };
+
+        while (reader.read_fields(visit)) {
+        }
+    }
+
+    template<typename Record, typename Source>
+    auto read_columns(tsv::basic_reader<Record, Source>& reader)
+    {
+        typename detail::column_tuple<detail::field_type_list<Record>>::type columns;
+        detail::read_columns(
+            reader, columns, std::make_index_sequence<detail::record_size_v<Record>>{}
+        );
+        return columns;
+    }
+}
+
+namespace tsv
+{
+    /**
+     * Tuple of vectors holding the values of the fields of Record in the
+     * structure-of-arrays layout: the i-th vector holds the i-th fields.
+     */
+    template<typename Record>
+    using columns = typename detail::column_tuple<
+        detail::field_type_list<Record>
+    >::type;
+
+    /**
+     * Loads tab-separated values into columns. This is equivalent to
+     * transposing the result of `tsv::load` but without the intermediate
+     * vector of records.
+     *
+     * @param input is a stream containing a tab-separated document.
+     * @param opts control how the parser behaves.
+     *
+     * @returns A tuple of vectors, one per field of Record.
+     */
+    template<typename Record>
+    tsv::columns<Record> load_columns(
+        std::istream& input, tsv::options const& opts = {}
+    )
+    {
+        tsv::reader<Record> reader{input, opts};
+        return detail::read_columns(reader);
+    }
+
+    template<typename Record>
+    tsv::columns<Record> load_columns(
+        std::istream&& input, tsv::options const& opts = {}
+    )
+    {
+        return tsv::load_columns<Record>(input, opts);
+    }
+
+    /**
+     * Loads tab-separated values from a file into columns. See
+     * `tsv::load_columns` and `tsv::load_file`.
+     */
+    template<typename Record>
+    tsv::columns<Record> load_file_columns(
+        std::filesystem::path const& path, tsv::options const& opts = {}
+    )
+    {
+        static_assert(
+            !detail::has_view_field_v<Record>,
+            "string_view fields would outlive the file"
+        );
+        tsv::file_reader<Record> reader{path, opts};
+        return detail::read_columns(reader);
+    }
+}
+
+// DYNAMIC TABLE -------------------------------------------------------------
+
+namespace tsv
+{
+    /** Types of the columns of a `tsv::dynamic_table`. */
+    enum class column_type
+    {
+        /** 64-bit signed integer. */
+        int64,
+
+        /** Double-precision floating-point number. */
+        float64,
+
+        /** Text stored in the table. */
+        string,
+
+        /** Text interned in the `dictionary` option, stored as a code. */
+        interned,
+    };
+
+    /** Name and type of a column of a `tsv::dynamic_table`. */
+    struct column_spec
+    {
+        std::string name;
+        tsv::column_type type = tsv::column_type::string;
+    };
+
+    /**
+     * Table of columns whose types are given at runtime. Each column is
+     * stored in a typed buffer: numbers in a vector, and texts back to back
+     * in one character buffer with the offsets of the texts. Appending a
+     * row allocates nothing except when a buffer grows.
+     *
+     * Accessing a column as a wrong type throws std::invalid_argument.
+     */
+    class dynamic_table
+    {
+    public:
+        dynamic_table() = default;
+
+        /** Constructs an empty table with the columns in a schema. */
+        explicit dynamic_table(
+            std::vector<tsv::column_spec> schema,
+            tsv::dictionary const* dictionary = nullptr
+        )
+            : _schema{std::move(schema)}, _dictionary{dictionary}
+        {
+            for (auto const& spec : _schema) {
+                buffer col;
+                col.type = spec.type;
+                _columns.push_back(std::move(col));
+            }
+        }
+
+        /** Returns the schema of the table. */
+        std::vector<tsv::column_spec> const& schema() const
+        {
+            return _schema;
+        }
+
+        /** Returns the number of rows. */
+        std::size_t size() const
+        {
+            return _size;
+        }
+
+        /** Returns the number of columns. */
+        std::size_t column_count() const
+        {
+            return _columns.size();
+        }
+
+        /**
+         * Returns the index of a column by name. Throws std::invalid_argument
+         * if the schema has no such column.
+         */
+        std::size_t column(std::string_view name) const
+        {
+            for (std::size_t i = 0; i < _schema.size(); i++) {
+                if (_schema[i].name == name) {
+                    return i;
+                }
+            }
+            throw std::invalid_argument{"column not found in schema"};
+        }
+
+        /** Returns the values of an int64 column. */
+        tsv::span<std::int64_t const> int64s(std::size_t column) const
+        {
+            auto const& values = typed(column, tsv::column_type::int64).int64s;
+            return {values.data(), values.size()};
+        }
+
+        /** Returns the values of a float64 column. */
+        tsv::span<double const> float64s(std::size_t column) const
+        {
+            auto const& values = typed(column, tsv::column_type::float64).float64s;
+            return {values.data(), values.size()};
+        }
+
+        /** Returns the dictionary codes of an interned column. */
+        tsv::span<std::uint32_t const> codes(std::size_t column) const
+        {
+            auto const& values = typed(column, tsv::column_type::interned).codes;
+            return {values.data(), values.size()};
+        }
+
+        /**
+         * Returns the text in a string or interned column. The text of an
+         * interned column is looked up in the dictionary.
+         */
+        std::string_view string(std::size_t column, std::size_t row) const
+        {
+            auto const& col = _columns.at(column);
+
+            if (col.type == tsv::column_type::interned && _dictionary) {
+                return (*_dictionary)[col.codes.at(row)];
+            }
+
+            auto const& strings = typed(column, tsv::column_type::string);
+            auto const begin = strings.offsets.at(row);
+            auto const end = strings.offsets.at(row + 1);
+            return std::string_view{strings.chars}.substr(begin, end - begin);
+        }
+
+        /** Removes all the rows. The buffers are kept for reuse. */
+        void clear()
+        {
+            truncate(0);
+        }
+
+        /** Reserves the buffers for a number of rows. */
+        void reserve(std::size_t rows)
+        {
+            for (auto& col : _columns) {
+                switch (col.type) {
+                case tsv::column_type::int64:
+                    col.int64s.reserve(rows);
+                    break;
+                case tsv::column_type::float64:
+                    col.float64s.reserve(rows);
+                    break;
+                case tsv::column_type::string:
+                    col.offsets.reserve(rows + 1);
+                    break;
+                case tsv::column_type::interned:
+                    col.codes.reserve(rows);
+                    break;
+                }
+            }
+        }
+
+        /**
+         * Parses the fields of a row into the columns. `fields[i]` is the
+         * index of the field in the row for the i-th column. If a field fails
+         * to parse, the error is thrown and nothing is appended.
+         */
+        void append(tsv::row const& row, std::vector<std::size_t> const& fields)
+        {
+            if (fields.size() != _columns.size()) {
+                throw std::invalid_argument{
+                    "number of fields does not match number of columns"
+                };
+            }
+
+            try {
+                for (std::size_t i = 0; i < _columns.size(); i++) {
+                    auto& col = _columns[i];
+                    auto const field = fields[i];
+
+                    switch (col.type) {
+                    case tsv::column_type::int64:
+                        col.int64s.push_back(row.get<std::int64_t>(field));
+                        break;
+                    case tsv::column_type::float64:
+                        col.float64s.push_back(row.get<double>(field));
+                        break;
+                    case tsv::column_type::string:
+                        col.chars += row.field(field);
+                        col.offsets.push_back(col.chars.size());
+                        break;
+                    case tsv::column_type::interned:
+                        col.codes.push_back(row.get<tsv::interned<>>(field).code);
+                        break;
+                    }
+                }
+            } catch (...) {
+                truncate(_size);
+                throw;
+            }
+
+            _size++;
+        }
+
+    private:
+        /** Values of a column. Only the buffers for its type are used. */
+        struct buffer
+        {
+            tsv::column_type type = tsv::column_type::string;
+            std::vector<std::int64_t> int64s;
+            std::vector<double> float64s;
+            std::vector<std::uint32_t> codes;
+            std::string chars;
+            std::vector<std::size_t> offsets = {0};
+        };
+
+        buffer const& typed(std::size_t column, tsv::column_type type) const
+        {
+            auto const& col = _columns.at(column);
+            if (col.type != type) {
+                throw std::invalid_argument{"column is not of the requested type"};
+            }
+            return col;
+        }
+
+        /** Drops the values of the rows after the first `rows` rows. */
+        void truncate(std::size_t rows)
+        {
+            for (auto& col : _columns) {
+                switch (col.type) {
+                case tsv::column_type::int64:
+                    col.int64s.resize(std::min(col.int64s.size(), rows));
+                    break;
+                case tsv::column_type::float64:
+                    col.float64s.resize(std::min(col.float64s.size(), rows));
+                    break;
+                case tsv::column_type::string:
+                    col.offsets.resize(std::min(col.offsets.size(), rows + 1));
+                    col.chars.resize(col.offsets.back());
+                    break;
+                case tsv::column_type::interned:
+                    col.codes.resize(std::min(col.codes.size(), rows));
+                    break;
+                }
+            }
+            _size = rows;
+        }
+
+        std::vector<tsv::column_spec> _schema;
+        std::vector<buffer> _columns;
+        tsv::dictionary const* _dictionary = nullptr;
+        std::size_t _size = 0;
+    };
+}
+
+namespace tsv::detail
+{
+    /**
+     * Finds the fields of the columns in a schema. The columns are looked up
+     * by name in the header, or taken from the `columns` option, or from the
+     * leading fields in order.
+     */
+    inline
+    std::vector<std::size_t> bind_schema(
+        std::vector<tsv::column_spec> const& schema,
+        std::vector<std::string> const& header,
+        tsv::options const& opts
+    )
+    {
+        std::vector<std::size_t> fields;
+
+        if (opts.header) {
+            for (auto const& spec : schema) {
+                auto const pos = std::find(header.begin(), header.end(), spec.name);
+                if (pos == header.end()) {
+                    throw tsv::format_error{tsv::format_error::missing_column};
+                }
+                fields.push_back(static_cast<std::size_t>(pos - header.begin()));
+            }
+        } else if (!opts.columns.empty()) {
+            if (opts.columns.size() != schema.size()) {
+                throw std::invalid_argument{
+                    "number of columns does not match the schema"
+                };
+            }
+            fields = opts.columns;
+        } else {
+            for (std::size_t i = 0; i < schema.size(); i++) {
+                fields.push_back(i);
+            }
+        }
+
+        return fields;
+    }
+
+    /** Reads all rows from a line source into a dynamic table. */
+    template<typename Source, typename Input>
+    tsv::dynamic_table read_table(
+        Input&& input,
+        std::vector<tsv::column_spec> schema,
+        tsv::options const& opts
+    )
+    {
+        if (opts.on_error == tsv::error_policy::collect && !opts.rejected) {
+            throw std::invalid_argument{
+                "rejected vector is required for the collect policy"
+            };
+        }
+
+        if (opts.progress && !opts.stats) {
+            throw std::invalid_argument{
+                "stats object is required for the progress function"
+            };
+        }
+
+        bool const interned = std::any_of(schema.begin(), schema.end(), [](auto const& spec) {
+            return spec.type == tsv::column_type::interned;
+        });
+        if (interned && !opts.dictionary) {
+            throw std::invalid_argument{"dictionary is required for interned fields"};
+        }
+
+        detail::basic_parser<Source> parser{
+            detail::source_input<Source>(std::forward<Input>(input), opts),
+            opts.delimiter,
+            detail::make_context(opts)
+        };
+
+        parser.skip_comment(opts.comment);
+
+        std::vector<std::string> header;
+        if (opts.header) {
+            if (!parser.parse_fields(header)) {
+                throw tsv::format_error{tsv::format_error::missing_header};
+            }
+        }
+
+        auto const fields = detail::bind_schema(schema, header, opts);
+
+        if (!opts.filters.empty()) {
+            parser.set_filters(opts.filters);
+        }
+
+        tsv::dynamic_table table{std::move(schema), opts.dictionary};
+        tsv::row row{opts.delimiter, parser.context(), nullptr, 0};
+
+        auto const stats = parser.context().stats;
+        auto const interval = std::max(opts.progress_interval, std::size_t(1));
+        std::size_t pending_rows = 0;
+
+        for (;;) {
+            parser.skip_comment(opts.comment);
+
+            auto const line = parser.read_line();
+            if (!line) {
+                break;
+            }
+            row.assign(*line, parser.line_number());
+
+            try {
+                table.append(row, fields);
+            } catch (tsv::io_error const&) {
+                throw;
+            } catch (tsv::error const& err) {
+                if (opts.on_error == tsv::error_policy::raise) {
+                    throw;
+                }
+                if (stats) {
+                    stats->rejected_rows++;
+                }
+                if (opts.on_error == tsv::error_policy::collect) {
+                    opts.rejected->push_back(err);
+                }
+                continue;
+            }
+
+            if (stats) {
+                stats->rows++;
+                if (opts.progress && ++pending_rows >= interval) {
+                    pending_rows = 0;
+                    opts.progress(*stats);
+                }
+            }
+        }
+
+        if (stats && opts.progress) {
+            opts.progress(*stats);
+        }
+
+        return table;
+    }
+}
+
+namespace tsv
+{
+    /**
+     * Loads tab-separated values into a table with the columns given at
+     * runtime. The fields are converted as in `tsv::load`, and texts are
+     * copied into the buffer of the column.
+     *
+     * ```
+     * std::vector<tsv::column_spec> schema = {
+     *     {"id", tsv::column_type::int64},
+     *     {"name", tsv::column_type::string},
+     * };
+     * auto const table = tsv::load_table(input, schema);
+     * auto const ids = table.int64s(0);
+     * ```
+     *
+     * Columns are looked up by name in the header. If the header is
+     * disabled, the `columns` option selects the columns, or the leading
+     * columns are taken in order.
+     *
+     * @param input is a stream containing a tab-separated document.
+     * @param schema lists the names and the types of the columns.
+     * @param opts control how the parser behaves.
+     *
+     * @returns A table holding the loaded columns.
+     */
+    inline
+    tsv::dynamic_table load_table(
+        std::istream& input,
+        std::vector<tsv::column_spec> schema,
+        tsv::options const& opts = {}
+    )
+    {
+        return detail::read_table<detail::line_reader>(input, std::move(schema), opts);
+    }
+
+    inline
+    tsv::dynamic_table load_table(
+        std::istream&& input,
+        std::vector<tsv::column_spec> schema,
+        tsv::options const& opts = {}
+    )
+    {
+        return tsv::load_table(input, std::move(schema), opts);
+    }
+
+    /**
+     * Loads tab-separated values from a file into a table with the columns
+     * given at runtime. See `tsv::load_table`.
+     */
+    inline
+    tsv::dynamic_table load_table_file(
+        std::filesystem::path const& path,
+        std::vector<tsv::column_spec> schema,
+        tsv::options const& opts = {}
+    )
+    {
+        return detail::read_table<detail::file_line_reader>(path, std::move(schema), opts);
+    }
+}
+
+// PARALLEL LOADING ----------------------------------------------------------
+
+namespace tsv::detail
+{
+    /**
+     * Splits a text into chunks of roughly equal size. Each chunk except the
+     * last one ends with a newline, so the chunks consist of whole lines.
+     */
+    inline
+    std::vector<std::string_view> split_lines(std::string_view text, std::size_t count)
+    {
+        std::vector<std::string_view> chunks;
+        auto const target_size = text.size() / (count ? count : 1) + 1;
+
+        while (!text.empty()) {
+            auto const newline = text.size() > target_size
+                ? text.find('\n', target_size - 1)
+                : std::string_view::npos;
+            auto const size = newline != std::string_view::npos
+                ? newline + 1
+                : text.size();
+            chunks.push_back(text.substr(0, size));
+            text.remove_prefix(size);
+        }
+
+        return chunks;
+    }
+
+    /** Records and the number of lines parsed from a chunk. */
+    template<typename Record>
+    struct chunk_result
+    {
+        std::vector<Record> records;
+        std::vector<tsv::error> rejected;
+        std::size_t lines = 0;
+        std::exception_ptr error;
+    };
+
+    /** Location of the body of a text and the options to parse the body. */
+    struct text_body
+    {
+        tsv::options options;
+        std::size_t offset = 0;
+        std::size_t line_number = 0;
+    };
+
+    /**
+     * Reads the leading comments and the header of a text. The returned
+     * options parse the rest of the text with the columns resolved against
+     * the header.
+     */
+    inline
+    detail::text_body read_prologue(std::string_view text, tsv::options const& opts)
+    {
+        detail::memory_reader prologue{text};
+        detail::basic_parser<detail::memory_reader&> parser{
+            prologue, opts.delimiter, detail::make_context(opts)
+        };
+
+        parser.skip_comment(opts.comment);
+
+        std::vector<std::string> header;
+        if (opts.header) {
+            if (!parser.parse_fields(header)) {
+                throw tsv::format_error{tsv::format_error::missing_header};
+            }
+        }
+
+        detail::text_body body;
+        body.options = opts;
+        body.options.header = false;
+        body.options.columns = detail::bind_columns(opts, header);
+        body.options.column_names.clear();
+        body.offset = prologue.offset();
+        body.line_number = prologue.line_number();
+        return body;
+    }
+
+    /**
+     * Parses chunks of whole lines concurrently and concatenates the records
+     * in order. `first_line` is the number of lines preceding the first
+     * chunk, which is used to compute the line numbers in errors. Rejected
+     * rows are appended to `rejected` in order. The statistics of each chunk
+     * are added to `chunk_opts.stats` when the chunk is done.
+     */
+    template<typename Record>
+    std::vector<Record> load_chunks(
+        std::vector<std::string_view> const& chunks,
+        std::size_t first_line,
+        tsv::options const& chunk_opts,
+        std::vector<tsv::error>* rejected,
+        std::size_t threads
+    )
+    {
+        std::vector<detail::chunk_result<Record>> results(chunks.size());
+
+        std::mutex dictionary_mutex;
+        std::mutex stats_mutex;
+
+        // Index of the first failed chunk. Chunks after it are abandoned.
+        std::atomic<std::size_t> first_error{chunks.size()};
+
+        detail::run_parallel(chunks.size(), threads, [&](std::size_t i) {
+            auto& result = results[i];
+            detail::memory_reader source{chunks[i]};
+
+            // The dictionary is shared by the workers.
+            std::unordered_map<std::string_view, std::uint32_t> dictionary_cache;
+            auto context = detail::make_context(chunk_opts);
+            context.stats = nullptr;
+            context.dictionary_mutex = &dictionary_mutex;
+            context.dictionary_cache = &dictionary_cache;
+
+            // Statistics are counted per chunk and merged under the lock.
+            tsv::load_stats stats;
+            if (chunk_opts.stats) {
+                context.stats = &stats;
+            }
+
+            // Rejected rows are merged in the input order afterwards.
+            auto worker_opts = chunk_opts;
+            worker_opts.rejected = &result.rejected;
+            worker_opts.progress = nullptr;
+
+            try {
+                using reader_type = tsv::basic_reader<Record, detail::memory_reader&>;
+                reader_type reader{source, worker_opts, context};
+
+                for (;;) {
+                    if (first_error.load(std::memory_order_relaxed) < i) {
+                        break;
+                    }
+
+                    if (!reader.read_block(result.records, reader_type::default_block_rows)) {
+                        break;
+                    }
+                }
+
+                if (chunk_opts.stats) {
+                    std::lock_guard<std::mutex> lock{stats_mutex};
+                    *chunk_opts.stats += stats;
+                    if (chunk_opts.progress) {
+                        chunk_opts.progress(*chunk_opts.stats);
+                    }
+                }
+            } catch (...) {
+                result.error = std::current_exception();
+
+                auto expected = first_error.load();
+                while (i < expected && !first_error.compare_exchange_weak(expected, i)) {
+                }
+            }
+
+            result.lines = source.line_number();
+        });
+
+        std::size_t total = 0;
+        auto line_offset = first_line;
+
+        for (auto& result : results) {
+            if (result.error) {
+                try {
+                    std::rethrow_exception(result.error);
+                } catch (tsv::error& err) {
+                    if (err.line_number) {
+                        err.line_number += line_offset;
+                    }
+                    throw;
+                }
+            }
+            total += result.records.size();
+
+            for (auto& err : result.rejected) {
+                err.line_number += line_offset;
+                rejected->push_back(std::move(err));
+            }
+            line_offset += result.lines;
+        }
+
+        std::vector<Record> records;
+        records.reserve(total);
+
+        for (auto& result : results) {
+            std::move(
+                result.records.begin(),
+                result.records.end(),
+                std::back_inserter(records)
+            );
+            result.records = std::vector<Record>{};
+        }
+
+        return records;
+    }
+
+    /** Checks the options for the loaders that use worker threads. */
+    inline
+    void check_parallel_options(tsv::options const& opts)
+    {
+        if (opts.on_error == tsv::error_policy::collect && !opts.rejected) {
+            throw std::invalid_argument{
+                "rejected vector is required for the collect policy"
+            };
+        }
+
+        if (opts.progress && !opts.stats) {
+            throw std::invalid_argument{
+                "stats object is required for the progress function"
+            };
+        }
+    }
+}
+
+namespace tsv
+{
+    /**
+     * Loads tab-separated values from an in-memory text using multiple
+     * threads. The text is split into chunks at line boundaries and the
+     * chunks are parsed concurrently. The records are returned in the input
+     * order, and errors report the line number in the entire text. Codes of
+     * interned fields depend on the timing of the threads.
+     *
+     * @param text is a tab-separated document.
+     * @param opts control how the parser behaves.
+     * @param threads is the number of worker threads. Zero means the number
+     *   of hardware threads.
+     *
+     * @returns A vector of loaded records.
+     */
+    template<typename Record>
+    std::vector<Record> parallel_load(
+        std::string_view text,
+        tsv::options const& opts = {},
+        std::size_t threads = 0
+    )
+    {
+        // Chunks smaller than this are not worth a thread.
+        constexpr std::size_t min_chunk_size = std::size_t(1) << 16;
+
+        detail::check_parallel_options(opts);
+
+        auto const body = detail::read_prologue(text, opts);
+        auto const body_text = text.substr(body.offset);
+
+        threads = detail::thread_count(threads);
+        auto const max_chunks = body_text.size() / min_chunk_size + 1;
+        auto const chunks = detail::split_lines(
+            body_text, std::min(threads * 4, max_chunks)
+        );
+
+        return detail::load_chunks<Record>(
+            chunks, body.line_number, body.options, opts.rejected, threads
+        );
+    }
+
+    /**
+     * Loads tab-separated values from a file using multiple threads. The file
+     * is memory-mapped if possible and parsed with `tsv::parallel_load`.
+     *
+     * @param path is the path of a file containing a tab-separated document.
+     * @param opts control how the parser behaves.
+     * @param threads is the number of worker threads. Zero means the number
+     *   of hardware threads.
+     *
+     * @returns A vector of loaded records.
+     */
+    template<typename Record>
+    std::vector<Record> parallel_load_file(
+        std::filesystem::path const& path,
+        tsv::options const& opts = {},
+        std::size_t threads = 0
+    )
+    {
+        static_assert(
+            !detail::has_view_field_v<Record>,
+            "string_view fields would outlive the file; "
+            "use tsv::load_file_document or tsv::document"
+        );
+
+        detail::mapped_file const file{path};
+        return tsv::parallel_load<Record>(file.view(), opts, threads);
+    }
+}
+
+// MULTI-FILE LOADING --------------------------------------------------------
+
+namespace tsv::detail
+{
+    /**
+     * Loads files concurrently, one file per task. Each file is parsed with
+     * the header and comment settings in the options. Errors and rejected
+     * rows carry the path of the file in `tsv::error::source`. The error of
+     * the first failed file in the given order is thrown.
+     */
+    template<typename Record>
+    std::vector<detail::chunk_result<Record>> load_shards(
+        tsv::span<std::filesystem::path const> paths,
+        tsv::options const& opts,
+        std::size_t threads
+    )
+    {
+        static_assert(
+            !detail::has_view_field_v<Record>,
+            "string_view fields would outlive the file; "
+            "use tsv::load_file_document or tsv::document"
+        );
+
+        detail::check_parallel_options(opts);
+
+        if (!opts.cache.empty()) {
+            throw std::invalid_argument{"cache cannot be shared by multiple files"};
+        }
+
+        // Larger files are started first so that a large file at the end
+        // does not leave the other threads idle.
+        std::vector<std::uintmax_t> sizes(paths.size());
+        std::vector<std::size_t> order(paths.size());
+
+        for (std::size_t i = 0; i < paths.size(); i++) {
+            std::error_code ec;
+            auto const size = std::filesystem::file_size(paths[i], ec);
+            sizes[i] = ec ? 0 : size;
+            order[i] = i;
+        }
+
+        std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+            return sizes[a] > sizes[b];
+        });
+
+        std::vector<detail::chunk_result<Record>> results(paths.size());
+
+        std::mutex dictionary_mutex;
+        std::mutex stats_mutex;
+
+        // Index of the first failed file. Files after it are abandoned.
+        std::atomic<std::size_t> first_error{paths.size()};
+
+        detail::run_parallel(paths.size(), detail::thread_count(threads), [&](std::size_t task) {
+            auto const i = order[task];
+            auto& result = results[i];
+
+            if (first_error.load(std::memory_order_relaxed) < i) {
+                return;
+            }
+
+            std::unordered_map<std::string_view, std::uint32_t> dictionary_cache;
+            auto context = detail::make_context(opts);
+            context.stats = nullptr;
+            context.dictionary_mutex = &dictionary_mutex;
+            context.dictionary_cache = &dictionary_cache;
+
+            tsv::load_stats stats;
+            if (opts.stats) {
+                context.stats = &stats;
+            }
+
+            auto file_opts = opts;
+            file_opts.rejected = &result.rejected;
+            file_opts.progress = nullptr;
+
+            try {
+                using reader_type = tsv::file_reader<Record>;
+                reader_type reader{paths[i], file_opts, context};
+
+                for (;;) {
+                    if (first_error.load(std::memory_order_relaxed) < i) {
+                        break;
+                    }
+
+                    if (!reader.read_block(result.records, reader_type::default_block_rows)) {
+                        break;
+                    }
+                }
+
+                if (opts.stats) {
+                    std::lock_guard<std::mutex> lock{stats_mutex};
+                    *opts.stats += stats;
+                    if (opts.progress) {
+                        opts.progress(*opts.stats);
+                    }
+                }
+            } catch (...) {
+                result.error = std::current_exception();
+
+                auto expected = first_error.load();
+                while (i < expected && !first_error.compare_exchange_weak(expected, i)) {
+                }
+            }
+        });
+
+        for (std::size_t i = 0; i < results.size(); i++) {
+            auto& result = results[i];
+
+            if (result.error) {
+                try {
+                    std::rethrow_exception(result.error);
+                } catch (tsv::error& err) {
+                    err.source = paths[i].string();
+                    throw;
+                }
+            }
+
+            if (opts.rejected) {
+                for (auto& err : result.rejected) {
+                    err.source = paths[i].string();
+                    opts.rejected->push_back(std::move(err));
+                }
+            }
+            result.rejected.clear();
+        }
+
+        return results;
+    }
+}
+
+namespace tsv
+{
+    /**
+     * Loads tab-separated values from multiple files using multiple threads.
+     * The files are parsed concurrently, each with the header and comment
+     * settings in the options, and the records are returned per file in the
+     * given order. Errors report the path of the file in `tsv::error::source`.
+     * Codes of interned fields depend on the timing of the threads.
+     *
+     * ```
+     * std::vector<std::filesystem::path> paths = {"part-0.tsv", "part-1.tsv"};
+     * auto const shards = tsv::load_shards<my_record>(paths);
+     * ```
+     *
+     * The cache option is not supported.
+     *
+     * @param paths are the paths of files containing tab-separated documents.
+     * @param opts control how the parser behaves.
+     * @param threads is the number of worker threads. Zero means the number
+     *   of hardware threads.
+     *
+     * @returns A vector of loaded records for each file.
+     */
+    template<typename Record>
+    std::vector<std::vector<Record>> load_shards(
+        tsv::span<std::filesystem::path const> paths,
+        tsv::options const& opts = {},
+        std::size_t threads = 0
+    )
+    {
+        auto results = detail::load_shards<Record>(paths, opts, threads);
+
+        std::vector<std::vector<Record>> shards;
+        shards.reserve(results.size());
+        for (auto& result : results) {
+            shards.push_back(std::move(result.records));
+        }
+        return shards;
+    }
+
+    template<typename Record>
+    std::vector<std::vector<Record>> load_shards(
+        std::vector<std::filesystem::path> const& paths,
+        tsv::options const& opts = {},
+        std::size_t threads = 0
+    )
+    {
+        return tsv::load_shards<Record>(
+            tsv::span<std::filesystem::path const>{paths.data(), paths.size()},
+            opts,
+            threads
+        );
+    }
+
+    /**
+     * Loads tab-separated values from multiple files using multiple threads
+     * and concatenates the records in the given order of the files. See
+     * `tsv::load_shards`.
+     *
+     * @param paths are the paths of files containing tab-separated documents.
+     * @param opts control how the parser behaves.
+     * @param threads is the number of worker threads. Zero means the number
+     *   of hardware threads.
+     *
+     * @returns A vector of loaded records.
+     */
+    template<typename Record>
+    std::vector<Record> load_files(
+        tsv::span<std::filesystem::path const> paths,
+        tsv::options const& opts = {},
+        std::size_t threads = 0
+    )
+    {
+        auto results = detail::load_shards<Record>(paths, opts, threads);
+
+        std::size_t total = 0;
+        for (auto const& result : results) {
+            total += result.records.size();
+        }
+
+        std::vector<Record> records;
+        records.reserve(total);
+
+        for (auto& result : results) {
+            std::move(
+                result.records.begin(),
+                result.records.end(),
+                std::back_inserter(records)
+            );
+            result.records = std::vector<Record>{};
+        }
+
+        return records;
+    }
+
+    template<typename Record>
+    std::vector<Record> load_files(
+        std::vector<std::filesystem::path> const& paths,
+        tsv::options const& opts = {},
+        std::size_t threads = 0
+    )
+    {
+        return tsv::load_files<Record>(
+            tsv::span<std::filesystem::path const>{paths.data(), paths.size()},
+            opts,
+            threads
+        );
+    }
+}
+
+// TAIL FOLLOWING ------------------------------------------------------------
+
+namespace tsv
+{
+    /**
+     * Reads records from a file that is still being appended to, such as a
+     * log. Each call to `poll` parses the complete lines appended since the
+     * last call. A trailing line without a newline is kept in the buffer
+     * until the rest of the line is written.
+     *
+     * ```
+     * tsv::tail_reader<my_record> tail{"events.tsv"};
+     * std::vector<my_record> records;
+     *
+     * for (;;) {
+     *     records.clear();
+     *     tail.poll(records);
+     *     ...
+     *     std::this_thread::sleep_for(std::chrono::seconds(1));
+     * }
+     * ```
+     *
+     * The file is kept open and only the new bytes are read on each poll.
+     * Compressed files are not supported. Errors report the line number in
+     * the entire file.
+     */
+    template<typename Record>
+    class tail_reader
+    {
+        static_assert(
+            !detail::has_view_field_v<Record>,
+            "string_view fields would outlive the buffered lines"
+        );
+
+    public:
+        /**
+         * Opens a file. Nothing is read until the first poll.
+         *
+         * @param path is the path of a file containing a tab-separated
+         *   document.
+         * @param opts control how the parser behaves.
+         */
+        explicit tail_reader(
+            std::filesystem::path const& path, tsv::options const& opts = {}
+        )
+            : _path{path}
+            , _file{path, std::ios::binary}
+            , _opts{opts}
+            , _context{detail::make_context(opts)}
+        {
+            if (!_file) {
+                throw tsv::io_error{tsv::io_error::cannot_open};
+            }
+
+            if (!opts.cache.empty()) {
+                throw std::invalid_argument{"cache cannot be used for a growing file"};
+            }
+
+            _opts.cache.clear();
+            _started = !opts.header;
+        }
+
+        tail_reader(tail_reader const&) = delete;
+        tail_reader& operator=(tail_reader const&) = delete;
+
+        /**
+         * Reads the data appended to the file and parses the complete lines.
+         * The records are appended to a vector. If an error is thrown, the
+         * records appended in this call are removed and the next poll retries
+         * the same lines.
+         *
+         * @param records is the vector receiving the loaded records.
+         *
+         * @returns The number of records appended.
+         */
+        std::size_t poll(std::vector<Record>& records)
+        {
+            read_appended();
+
+            if (!_started && !read_prologue()) {
+                return 0;
+            }
+
+            auto const end = _pending.rfind('\n');
+            if (end == std::string::npos) {
+                return 0;
+            }
+            auto const body = std::string_view{_pending}.substr(0, end + 1);
+            auto const first = records.size();
+
+            detail::memory_reader source{body};
+            std::vector<tsv::error> rejected;
+
+            try {
+                auto body_opts = _opts;
+                body_opts.rejected = &rejected;
+
+                tsv::basic_reader<Record, detail::memory_reader&> reader{
+                    source, body_opts, _context
+                };
+                reader.read_all(records);
+            } catch (tsv::error& err) {
+                records.erase(records.begin() + std::ptrdiff_t(first), records.end());
+                if (err.line_number) {
+                    err.line_number += _line_number;
+                }
+                throw;
+            } catch (...) {
+                records.erase(records.begin() + std::ptrdiff_t(first), records.end());
+                throw;
+            }
+
+            if (_opts.rejected) {
+                for (auto& err : rejected) {
+                    err.line_number += _line_number;
+                    _opts.rejected->push_back(std::move(err));
+                }
+            }
+
+            advance(body.size(), source.line_number());
+
+            return records.size() - first;
+        }
+
+        /**
+         * Returns the fields in the header line. Returns an empty vector if
+         * the header is disabled in the options or is not written yet.
+         */
+        std::vector<std::string> const& header() const
+        {
+            return _header;
+        }
+
+        /** Returns the number of complete lines consumed so far. */
+        std::size_t line_number() const
+        {
+            return _line_number;
+        }
+
+        /**
+         * Returns the byte offset in the file just past the last complete
+         * line consumed.
+         */
+        std::size_t offset() const
+        {
+            return _offset;
+        }
+
+    private:
+        /** Appends the bytes written after the last read to the buffer. */
+        void read_appended()
+        {
+            constexpr std::size_t read_size = std::size_t(1) << 16;
+
+            auto const known = _offset + _pending.size();
+
+            std::error_code ec;
+            auto const size = std::filesystem::file_size(_path, ec);
+            if (ec) {
+                throw tsv::io_error{tsv::io_error::unknown};
+            }
+            if (size < known) {
+                throw tsv::io_error{tsv::io_error::truncated_input};
+            }
+            if (size == known) {
+                return;
+            }
+
+            _file.clear();
+            _file.seekg(std::streamoff(known));
+
+            for (;;) {
+                auto const pos = _pending.size();
+                _pending.resize(pos + read_size);
+                _file.read(_pending.data() + pos, std::streamsize(read_size));
+
+                auto const count = _file.gcount();
+                _pending.resize(pos + std::size_t(count));
+                if (count <= 0) {
+                    break;
+                }
+            }
+
+            if (_file.bad()) {
+                throw tsv::io_error{tsv::io_error::unknown};
+            }
+        }
+
+        /**
+         * Consumes the comments and the header at the start of the file. The
+         * options are bound to the header for parsing the rest of the file.
+         * Returns false if the header is not complete yet.
+         */
+        bool read_prologue()
+        {
+            auto const end = _pending.rfind('\n');
+            if (end == std::string::npos) {
+                return false;
+            }
+
+            detail::memory_reader prologue{std::string_view{_pending}.substr(0, end + 1)};
+            detail::basic_parser<detail::memory_reader&> parser{
+                prologue, _opts.delimiter, detail::make_context(_opts)
+            };
+
+            parser.skip_comment(_opts.comment);
+
+            std::vector<std::string> header;
+            bool const found = parser.parse_fields(header);
+
+            if (found) {
+                _opts.columns = detail::bind_columns(_opts, header);
+                _opts.column_names.clear();
+                _opts.header = false;
+                _header = std::move(header);
+                _started = true;
+            }
+
+            // Leading comments are consumed even if the header is not seen.
+            advance(prologue.offset(), prologue.line_number());
+
+            return found;
+        }
+
+        void advance(std::size_t bytes, std::size_t lines)
+        {
+            _pending.erase(0, bytes);
+            _offset += bytes;
+            _line_number += lines;
+        }
+
+        std::filesystem::path _path;
+        std::ifstream _file;
+        tsv::options _opts;
+        detail::parse_context _context;
+        std::string _pending;
+        std::size_t _offset = 0;
+        std::size_t _line_number = 0;
+        bool _started = false;
+        std::vector<std::string> _header;
+    };
+}
+
+// ROW INDEX -----------------------------------------------------------------
+
+namespace tsv::detail
+{
+    /** Hashes the options that affect the rows counted in an index. */
+    inline
+    std::uint64_t index_settings(tsv::options const& opts)
+    {
+        detail::hasher hasher;
+        hasher.add(std::uint64_t(opts.header));
+        hasher.add(std::uint64_t(static_cast<unsigned char>(opts.comment)));
+        return hasher.value();
+    }
+
+    /** Header of an index file, followed by the checkpoints. */
+    struct index_header
+    {
+        char magic[8] = {'T', 'S', 'V', 'I', 'N', 'D', 'E', 'X'};
+        std::uint32_t version = 1;
+        std::uint32_t byte_order = 0x01020304;
+        std::uint64_t source_size = 0;
+        std::uint64_t settings = 0;
+        std::uint64_t stride = 0;
+        std::uint64_t rows = 0;
+        std::uint64_t count = 0;
+    };
+}
+
+namespace tsv
+{
+    /**
+     * Index of the rows in a tab-separated text. The byte offset and the line
+     * number of every `stride`-th row are recorded, so a range of rows can be
+     * read by seeking to the nearest checkpoint and skipping at most
+     * `stride - 1` lines. Comment and empty lines and the header are not
+     * counted as rows.
+     */
+    class index
+    {
+    public:
+        /** Location of an indexed row. */
+        struct checkpoint
+        {
+            /** Byte offset of the row in the text. */
+            std::uint64_t offset = 0;
+
+            /** Number of the lines preceding the row. */
+            std::uint64_t line_number = 0;
+        };
+
+        /** Default stride between checkpoints. */
+        static constexpr std::size_t default_stride = 1024;
+
+        /** Constructs an empty index. */
+        index() = default;
+
+        /**
+         * Builds an index by scanning the newlines in a text.
+         *
+         * @param text is a tab-separated document.
+         * @param opts specify the header and the comment prefix.
+         * @param stride is the number of rows between checkpoints.
+         */
+        explicit index(
+            std::string_view text,
+            tsv::options const& opts = {},
+            std::size_t stride = default_stride
+        )
+            : _source_size{text.size()}
+            , _settings{detail::index_settings(opts)}
+            , _stride{stride}
+        {
+            if (stride == 0) {
+                throw std::invalid_argument{"index stride must be positive"};
+            }
+
+            detail::memory_reader source{text};
+            bool header = opts.header;
+
+            while (auto const line = source.peek()) {
+                if (line->empty() || line->front() == opts.comment) {
+                    source.consume();
+                    continue;
+                }
+
+                if (header) {
+                    header = false;
+                    source.consume();
+                    continue;
+                }
+
+                if (_rows % _stride == 0) {
+                    checkpoint point;
+                    point.offset = source.offset();
+                    point.line_number = source.line_number() - 1;
+                    _checkpoints.push_back(point);
+                }
+                _rows++;
+                source.consume();
+            }
+
+            if (header) {
+                throw tsv::format_error{tsv::format_error::missing_header};
+            }
+        }
+
+        /** Returns the number of rows in the indexed text. */
+        std::size_t size() const
+        {
+            return _rows;
+        }
+
+        /** Returns the number of rows between checkpoints. */
+        std::size_t stride() const
+        {
+            return _stride;
+        }
+
+        /** Returns the size of the indexed text in bytes. */
+        std::uint64_t source_size() const
+        {
+            return _source_size;
+        }
+
+        /** Returns the checkpoints of the rows 0, stride, 2 stride, and so on. */
+        std::vector<checkpoint> const& checkpoints() const
+        {
+            return _checkpoints;
+        }
+
+        /**
+         * Throws `std::invalid_argument` if the index is not made for a text
+         * of the size with the options.
+         */
+        void check(std::size_t source_size, tsv::options const& opts) const
+        {
+            if (source_size != _source_size) {
+                throw std::invalid_argument{"index does not match the source size"};
+            }
+            if (detail::index_settings(opts) != _settings) {
+                throw std::invalid_argument{"index does not match the options"};
+            }
+        }
+
+        /** Saves the index to a file. Throws `tsv::io_error` on failure. */
+        void save(std::filesystem::path const& path) const
+        {
+            std::ofstream file{path, std::ios::binary | std::ios::trunc};
+            if (!file) {
+                throw tsv::io_error{tsv::io_error::cannot_open};
+            }
+
+            detail::index_header header;
+            header.source_size = _source_size;
+            header.settings = _settings;
+            header.stride = _stride;
+            header.rows = _rows;
+            header.count = _checkpoints.size();
+
+            file.write(reinterpret_cast<char const*>(&header), sizeof header);
+            file.write(
+                reinterpret_cast<char const*>(_checkpoints.data()),
+                static_cast<std::streamsize>(_checkpoints.size() * sizeof(checkpoint))
+            );
+
+            file.close();
+            if (!file) {
+                throw tsv::io_error{tsv::io_error::unknown};
+            }
+        }
+
+        /**
+         * Loads an index saved by `save`. Throws `tsv::io_error` if the file
+         * cannot be read or is not a valid index.
+         */
+        static tsv::index load(std::filesystem::path const& path)
+        {
+            std::ifstream file{path, std::ios::binary};
+            if (!file) {
+                throw tsv::io_error{tsv::io_error::cannot_open};
+            }
+
+            detail::index_header const expected;
+            detail::index_header header;
+
+            if (!file.read(reinterpret_cast<char*>(&header), sizeof header) ||
+                std::memcmp(header.magic, expected.magic, sizeof header.magic) != 0 ||
+                header.version != expected.version ||
+                header.byte_order != expected.byte_order ||
+                header.stride == 0 ||
+                header.count != (header.rows + header.stride - 1) / header.stride) {
+                throw tsv::io_error{tsv::io_error::corrupt_index};
+            }
+
+            tsv::index index;
+            index._source_size = header.source_size;
+            index._settings = header.settings;
+            index._stride = static_cast<std::size_t>(header.stride);
+            index._rows = static_cast<std::size_t>(header.rows);
+            index._checkpoints.resize(static_cast<std::size_t>(header.count));
+
+            auto const data_size = index._checkpoints.size() * sizeof(checkpoint);
+            if (!file.read(
+                reinterpret_cast<char*>(index._checkpoints.data()),
+                static_cast<std::streamsize>(data_size)
+            ) || file.peek() != std::ifstream::traits_type::eof()) {
+                throw tsv::io_error{tsv::io_error::corrupt_index};
+            }
+
+            for (std::size_t i = 1; i < index._checkpoints.size(); i++) {
+                auto const& prev = index._checkpoints[i - 1];
+                auto const& point = index._checkpoints[i];
+                if (point.offset <= prev.offset || point.line_number <= prev.line_number) {
+                    throw tsv::io_error{tsv::io_error::corrupt_index};
+                }
+            }
+            if (!index._checkpoints.empty() &&
+                index._checkpoints.back().offset >= index._source_size) {
+                throw tsv::io_error{tsv::io_error::corrupt_index};
+            }
+
+            return index;
+        }
+
+    private:
+        std::uint64_t _source_size = 0;
+        std::uint64_t _settings = 0;
+        std::size_t _stride = default_stride;
+        std::size_t _rows = 0;
+        std::vector<checkpoint> _checkpoints;
+    };
+
+    /**
+     * Builds an index of the rows in a file.
+     *
+     * @param path is the path of a file containing a tab-separated document.
+     * @param opts specify the header and the comment prefix.
+     * @param stride is the number of rows between checkpoints.
+     */
+    inline
+    tsv::index index_file(
+        std::filesystem::path const& path,
+        tsv::options const& opts = {},
+        std::size_t stride = tsv::index::default_stride
+    )
+    {
+        detail::mapped_file const file{path};
+        return tsv::index{file.view(), opts, stride};
+    }
+
+    /**
+     * Reads a range of rows from a text using an index. Only the lines from
+     * the nearest checkpoint are scanned. Errors report the line number in
+     * the entire text.
+     *
+     * @param text is the tab-separated document the index is built for.
+     * @param index is an index of the text built with the same options.
+     * @param first is the index of the first row to read.
+     * @param count is the number of rows to read. The range is clamped to
+     *   the number of rows in the text.
+     * @param opts control how the parser behaves.
+     *
+     * @returns A vector of loaded records. Rows rejected under the skip or
+     *   collect error policy or dropped by filters are not included; they
+     *   still count toward the range, so rows after it are never returned.
+     */
+    template<typename Record>
+    std::vector<Record> read_range(
+        std::string_view text,
+        tsv::index const& index,
+        std::size_t first,
+        std::size_t count,
+        tsv::options const& opts = {}
+    )
+    {
+        index.check(text.size(), opts);
+
+        first = std::min(first, index.size());
+        count = std::min(count, index.size() - first);
+
+        std::vector<Record> records;
+        if (count == 0) {
+            return records;
+        }
+        records.reserve(count);
+
+        auto const body = detail::read_prologue(text, opts);
+        auto const& point = index.checkpoints()[first / index.stride()];
+
+        // Locate the lines of the range without parsing them. The reader is
+        // bounded to those lines, so rows rejected or filtered out in the
+        // range never pull in rows after it.
+        auto const start = static_cast<std::size_t>(point.offset);
+        detail::memory_reader scanner{text.substr(start)};
+        detail::basic_parser<detail::memory_reader&> skipper{scanner, opts.delimiter};
+
+        auto const skip_rows = [&](std::size_t rows) {
+            for (; rows > 0; rows--) {
+                skipper.skip_comment(opts.comment);
+                if (!scanner.consume()) {
+                    break;
+                }
+            }
+        };
+
+        skip_rows(first % index.stride());
+        auto const range_begin = scanner.offset();
+        auto const line_offset =
+            static_cast<std::size_t>(point.line_number) + scanner.line_number();
+
+        skip_rows(count);
+        auto const range_end = scanner.offset();
+
+        detail::memory_reader source{
+            text.substr(start + range_begin, range_end - range_begin)
+        };
+
+        auto const rejected_before = opts.rejected ? opts.rejected->size() : 0;
+
+        try {
+            tsv::basic_reader<Record, detail::memory_reader&> reader{source, body.options};
+            reader.read_all(records);
+        } catch (tsv::error& err) {
+            if (err.line_number) {
+                err.line_number += line_offset;
+            }
+            throw;
+        }
+
+        if (opts.rejected) {
+            auto& rejected = *opts.rejected;
+            for (auto i = rejected_before; i < rejected.size(); i++) {
+                rejected[i].line_number += line_offset;
+            }
+        }
+
+        return records;
+    }
+
+    /**
+     * Reads a range of rows from a file using an index. The file is
+     * memory-mapped if possible, so the lookup costs a seek and a scan of at
+     * most `index.stride()` lines.
+     *
+     * @param path is the path of the file the index is built for.
+     * @param index is an index of the file built with the same options.
+     * @param first is the index of the first row to read.
+     * @param count is the number of rows to read.
+     * @param opts control how the parser behaves.
+     *
+     * @returns A vector of loaded records.
+     */
+    template<typename Record>
+    std::vector<Record> read_file_range(
+        std::filesystem::path const& path,
+        tsv::index const& index,
+        std::size_t first,
+        std::size_t count,
+        tsv::options const& opts = {}
+    )
+    {
+        static_assert(
+            !detail::has_view_field_v<Record>,
+            "string_view fields cannot refer to a file; use tsv::document"
+        );
+
+        detail::mapped_file const file{path};
+        return tsv::read_range<Record>(file.view(), index, first, count, opts);
+    }
+
+    /**
+     * Loads tab-separated values from a file using multiple threads, splitting
+     * the file at the checkpoints of an index instead of scanning for line
+     * boundaries.
+     *
+     * @param path is the path of the file the index is built for.
+     * @param index is an index of the file built with the same options.
+     * @param opts control how the parser behaves.
+     * @param threads is the number of worker threads. Zero means the number
+     *   of hardware threads.
+     *
+     * @returns A vector of loaded records.
+     */
+    template<typename Record>
+    std::vector<Record> parallel_load_file(
+        std::filesystem::path const& path,
+        tsv::index const& index,
+        tsv::options const& opts = {},
+        std::size_t threads = 0
+    )
+    {
+        static_assert(
+            !detail::has_view_field_v<Record>,
+            "string_view fields would outlive the file; "
+            "use tsv::load_file_document or tsv::document"
+        );
+
+        detail::check_parallel_options(opts);
+
+        detail::mapped_file const file{path};
+        auto const text = file.view();
+        index.check(text.size(), opts);
+
+        auto const body = detail::read_prologue(text, opts);
+        auto const& points = index.checkpoints();
+        if (points.empty()) {
+            return {};
+        }
+
+        threads = detail::thread_count(threads);
+        auto const step = (points.size() + threads * 4 - 1) / (threads * 4);
+
+        std::vector<std::string_view> chunks;
+        for (std::size_t i = 0; i < points.size(); i += step) {
+            auto const begin = static_cast<std::size_t>(points[i].offset);
+            auto const end = i + step < points.size()
+                ? static_cast<std::size_t>(points[i + step].offset)
+                : text.size();
+            chunks.push_back(text.substr(begin, end - begin));
+        }
+
+        return detail::load_chunks<Record>(
+            chunks,
+            static_cast<std::size_t>(points.front().line_number),
+            body.options,
+            opts.rejected,
+            threads
+        );
+    }
+}
+
+// BATCH PROCESSING ----------------------------------------------------------
+
+namespace tsv::detail
+{
+    /**
+     * Reads records from a reader in batches and calls `callback` with a span
+     * of each batch. The next batch is parsed on a second thread while the
+     * callback runs, using two buffers in turn. The batches are read on the
+     * calling thread if a thread cannot be created.
+     *
+     * Batches read before an error are passed to the callback, and then the
+     * error is rethrown. An exception thrown from the callback stops the
+     * parsing and is propagated.
+     */
+    template<typename Record, typename Source, typename Callback>
+    void for_each_batch(
+        tsv::basic_reader<Record, Source>& reader,
+        std::size_t batch_size,
+        Callback& callback
+    )
+    {
+        auto const fill = [&](std::vector<Record>& batch) {
+            batch.clear();
+
+            bool more = true;
+            while (more && batch.size() < batch_size) {
+                more = reader.read_block(batch, batch_size - batch.size());
+            }
+            return !batch.empty();
+        };
+
+        auto const call = [&](std::vector<Record> const& batch) {
+            callback(tsv::span<Record const>{batch.data(), batch.size()});
+        };
+
+        std::vector<Record> batches[2];
+        batches[0].reserve(batch_size);
+        batches[1].reserve(batch_size);
+
+        std::mutex mutex;
+        std::condition_variable cond;
+        bool full[2] = {};
+        bool done = false;
+        bool stop = false;
+        std::exception_ptr error;
+
+        auto const produce = [&] {
+            for (std::size_t i = 0; ; i ^= 1) {
+                {
+                    std::unique_lock<std::mutex> lock{mutex};
+                    cond.wait(lock, [&] { return !full[i] || stop; });
+                    if (stop) {
+                        return;
+                    }
+                }
+
+                bool filled = false;
+                try {
+                    filled = fill(batches[i]);
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock{mutex};
+                    error = std::current_exception();
+                }
+
+                {
+                    std::lock_guard<std::mutex> lock{mutex};
+                    full[i] = filled;
+                    done = !filled;
+                }
+                cond.notify_all();
+
+                if (!filled) {
+                    return;
+                }
+            }
+        };
+
+        std::thread producer;
+        try {
+            producer = std::thread{produce};
+        } catch (std::system_error const&) {
+            while (fill(batches[0])) {
+                call(batches[0]);
+            }
+            return;
+        }
+
+        try {
+            for (std::size_t i = 0; ; i ^= 1) {
+                {
+                    std::unique_lock<std::mutex> lock{mutex};
+                    cond.wait(lock, [&] { return full[i] || done; });
+                    if (!full[i]) {
+                        break;
+                    }
+                }
 
-            return value;
-        }
-    };
+                call(batches[i]);
 
-    /** Single-character token. */
-    template<>
-    struct default_conversion<char, void>
-    {
-        static char parse(std::string_view text)
-        {
-            if (text.size() != 1) {
-                throw tsv::parse_error{tsv::parse_error::unknown};
+                {
+                    std::lock_guard<std::mutex> lock{mutex};
+                    full[i] = false;
+                }
+                cond.notify_all();
+            }
+        } catch (...) {
+            {
+                std::lock_guard<std::mutex> lock{mutex};
+                stop = true;
             }
-            return text.front();
+            cond.notify_all();
+            producer.join();
+            throw;
         }
-    };
 
-    /** String token. */
-    template<>
-    struct default_conversion<std::string, void>
-    {
-        static std::string parse(std::string_view text)
-        {
-            return std::string{text};
+        producer.join();
+
+        if (error) {
+            std::rethrow_exception(error);
         }
-    };
+    }
 }
 
 namespace tsv
 {
-    template<typename T>
-    struct conversion : detail::default_conversion<T> {};
+    /**
+     * Loads tab-separated values in batches and passes each batch to a
+     * callback. Only two batches are kept in memory, and the next batch is
+     * parsed on a second thread while the callback processes the current
+     * one.
+     *
+     * ```
+     * tsv::for_each_batch<my_record>(
+     *     input, opts, 4096, [&](tsv::span<my_record const> batch) {
+     *         ...
+     *     }
+     * );
+     * ```
+     *
+     * @param input is a stream containing a tab-separated document.
+     * @param opts control how the parser behaves.
+     * @param batch_size is the maximum number of records in a batch. All
+     *   batches except the last one have this many records.
+     * @param callback is called with a `tsv::span<Record const>` of each
+     *   batch. The span is valid only during the call.
+     */
+    template<typename Record, typename Callback>
+    void for_each_batch(
+        std::istream& input,
+        tsv::options const& opts,
+        std::size_t batch_size,
+        Callback callback
+    )
+    {
+        if (batch_size == 0) {
+            throw std::invalid_argument{"batch size must be positive"};
+        }
+        tsv::reader<Record> reader{input, opts};
+        detail::for_each_batch(reader, batch_size, callback);
+    }
+
+    template<typename Record, typename Callback>
+    void for_each_batch(
+        std::istream&& input,
+        tsv::options const& opts,
+        std::size_t batch_size,
+        Callback callback
+    )
+    {
+        tsv::for_each_batch<Record>(input, opts, batch_size, std::move(callback));
+    }
+
+    /**
+     * Loads tab-separated values from a file in batches. See
+     * `tsv::for_each_batch`. string_view fields refer to the file content
+     * and are valid during the callback.
+     */
+    template<typename Record, typename Callback>
+    void for_each_file_batch(
+        std::filesystem::path const& path,
+        tsv::options const& opts,
+        std::size_t batch_size,
+        Callback callback
+    )
+    {
+        if (batch_size == 0) {
+            throw std::invalid_argument{"batch size must be positive"};
+        }
+        tsv::file_reader<Record> reader{path, opts};
+        detail::for_each_batch(reader, batch_size, callback);
+    }
 }
 
-// PARSER --------------------------------------------------------------------
+// WRITER --------------------------------------------------------------------
 
 namespace tsv::detail
 {
     /**
-     * Parses a value of type T from a string. Actual parsing is done by the
-     * tsv::conversion trait.
+     * Appends the text of a value to a string. Interned fields are written
+     * as the strings in the dictionary of the context.
      */
     template<typename T>
-    T parse(std::string_view text)
+    void format(T const& value, std::string& out, detail::parse_context const& context)
     {
-        return tsv::conversion<T>::parse(text);
+        if constexpr (detail::is_interned<T>::value) {
+            out += (*context.dictionary)[value.code];
+        } else {
+            tsv::conversion<T>::format(value, out);
+        }
     }
 
-    /**
-     * Splits a string at a delimiter and consumes the first part.
-     *
-     * @param text  String to split. The string will be trimmed up to the
-     *   first occurrence of the delimiter (or the end).
-     * @param delim  Delimiter character.
-     *
-     * @returns The substring of `text` that precedes the first occurence
-     *   of `delim`. Returns the entire input string if delim is not in the
-     *   input string.
-     */
+    /** Appends a text with backslash escapes to a string. */
     inline
-    std::string_view split_consume(std::string_view& text, char delim)
+    void escape(std::string_view text, char delim, std::string& out)
     {
-        auto const pos = text.find(delim);
-        if (pos != std::string_view::npos) {
-            auto const token = text.substr(0, pos);
-            text = text.substr(pos + 1);
-            return token;
-        } else {
-            auto const token = text;
-            text = text.substr(text.size());
-            return token;
+        for (auto const ch : text) {
+            switch (ch) {
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (ch == delim) {
+                    out += '\\';
+                }
+                out += ch;
+                break;
+            }
         }
     }
 
     /**
-     * Parses a structure out of a delimited text string. Record is the type of
-     * the structure to return and Ts... is the list of field types.
+     * Appends a field to a string. Throws tsv::format_error if the text would
+     * break the row, unless escapes are enabled. Numbers in the default format
+     * need not be checked unless the delimiter can be a part of a number.
      */
-    template<typename Record, typename... Ts>
-    Record parse_record(std::string_view text, char delim, detail::type_list<Ts...>)
+    template<typename T>
+    void format_field(
+        T const& value,
+        char delim,
+        std::string& out,
+        detail::parse_context const& context
+    )
     {
-        // This flag tracks whether all fields in the text have been consumed.
-        // We cannot use `text.empty()` for this purpose because the last field
-        // in `text` may be empty; e.g., text = "a|b|" with delim = '|'.
-        bool exhausted = false;
+        auto const start = out.size();
+        detail::format(value, out, context);
 
-        [[maybe_unused]]
-        auto consume_next = [&] {
-            if (exhausted) {
-                throw tsv::format_error{tsv::format_error::missing_field};
+        if constexpr (detail::is_fusable_v<T>) {
+            if (detail::is_fusable_delimiter(delim)) {
+                return;
             }
-            auto const field = detail::split_consume(text, delim);
-            exhausted = (field.end() == text.end());
-            return field;
+        }
+
+        auto const text = std::string_view{out}.substr(start);
+        auto const special = [&](char ch) {
+            return ch == delim || ch == '\n' || ch == '\r';
         };
 
-        Record record = {detail::parse<Ts>(consume_next())...};
-        if (!exhausted) {
-            throw tsv::format_error{tsv::format_error::excess_field};
+        if (context.escaping == tsv::escaping::backslash) {
+            bool const escaped = std::any_of(text.begin(), text.end(), [&](char ch) {
+                return ch == '\\' || special(ch);
+            });
+            if (escaped) {
+                std::string const raw{text};
+                out.resize(start);
+                detail::escape(raw, delim, out);
+            }
+            return;
         }
 
-        return record;
+        if (std::any_of(text.begin(), text.end(), special)) {
+            throw tsv::format_error{tsv::format_error::unwritable_field};
+        }
     }
 
-    /** Class for reading lines from a stream with one-line lookahead. */
-    class line_reader
+    /** Appends a delimited line of the fields of a structure to a string. */
+    template<typename Record, typename... Ts, std::size_t... Is>
+    void format_record(
+        Record const& record,
+        char delim,
+        std::string& out,
+        detail::type_list<Ts...>,
+        std::index_sequence<Is...>,
+        [[maybe_unused]] detail::parse_context const& context
+    )
     {
-    public:
-        explicit line_reader(std::istream& input)
-            : _input{input}
-        {
-        }
+        [[maybe_unused]] auto const fields = detail::tie_fields(record);
+        ((Is == 0 ? void() : out.push_back(delim),
+          detail::format_field<Ts>(std::get<Is>(fields), delim, out, context)), ...);
+        out += '\n';
+    }
+}
 
-        /**
-         * Reads next line. Returns a view of the internal buffer containing
-         * the content of the line, or nothing on reaching EOF.
-         */
-        std::optional<std::string_view> consume()
-        {
-            if (!ensure_line()) {
-                return std::nullopt;
-            }
-            _available = false;
-            return _line;
-        }
+namespace tsv
+{
+    /**
+     * Writes records to a stream as tab-separated values. Rows are formatted
+     * into a large buffer, and the buffer is written to the stream in blocks.
+     *
+     * ```
+     * std::ofstream file{"data.tsv"};
+     * tsv::options opts;
+     * opts.column_names = {"id", "name"};
+     * tsv::writer<my_record> writer{file, opts};
+     *
+     * for (auto const& record : records) {
+     *     writer.write(record);
+     * }
+     * writer.flush();
+     * ```
+     *
+     * Fields are formatted by `tsv::conversion<T>::format`. The destructor
+     * flushes the buffer but ignores errors, so call `flush()` to see them.
+     * The writer keeps a reference to the stream. The stream must outlive
+     * the writer.
+     */
+    template<typename Record>
+    class writer
+    {
+    public:
+        /** Number of bytes buffered before writing to the stream. */
+        static constexpr std::size_t block_size = std::size_t(1) << 20;
 
         /**
-         * Looks next line ahead. Returns a view of the internal buffer
-         * containing the content of the line, or nothing on reaching EOF.
+         * Constructs a writer. If the header is enabled in the options and
+         * `column_names` is set, the column names are written as the header
+         * line. A record type has no field names, so no header is written
+         * without `column_names`; unlike the reader, the header option alone
+         * does not expect a header. Load such output with `header` disabled.
+         * The other options except for the delimiter, the escaping and the
+         * dictionary are ignored.
+         *
+         * @param output is the stream to write to.
+         * @param opts control how the records are written.
          */
-        std::optional<std::string_view> peek()
+        explicit writer(std::ostream& output, tsv::options const& opts = {})
+            : _output{output}, _delim{opts.delimiter}, _context{detail::make_context(opts)}
         {
-            if (!ensure_line()) {
-                return std::nullopt;
+            if (detail::has_interned_field_v<Record> && !_context.dictionary) {
+                throw std::invalid_argument{
+                    "dictionary is required for interned fields"
+                };
             }
-            return _line;
-        }
-
-        /**
-         * Returns the current line number (one-based). Returns zero if any
-         * line has not been read yet.
-         */
-        std::size_t line_number() const
-        {
-            return _line_number;
-        }
 
-    private:
-        /**
-         * Ensures that `_line` contains the content of the next line. It does
-         * not read from the stream if `_line` is already filled by a previous
-         * lookahead. Returns true on success, or false on reaching EOF.
-         */
-        bool ensure_line()
-        {
-            if (_available) {
-                return true;
-            }
+            _buffer.reserve(block_size);
 
-            if (!std::getline(_input, _line)) {
-                if (_input.eof()) {
-                    return false;
+            if (opts.header && !opts.column_names.empty()) {
+                if (opts.column_names.size() != detail::record_size_v<Record>) {
+                    throw std::invalid_argument{
+                        "column names do not match record fields"
+                    };
                 }
-                throw tsv::io_error{tsv::io_error::unknown};
+                for (auto const& name : opts.column_names) {
+                    if (&name != &opts.column_names.front()) {
+                        _buffer += _delim;
+                    }
+                    detail::format_field(name, _delim, _buffer, _context);
+                }
+                _buffer += '\n';
             }
-
-            _line_number++;
-            _available = true;
-
-            return true;
-        }
-
-    private:
-        std::istream& _input;
-        std::string _line;
-        std::size_t _line_number = 0;
-        bool _available = false;
-    };
-
-    /** Class for incrementally reading TSV rows from a stream. */
-    class parser
-    {
-    public:
-        /** Constructs a TSV parser with given input and delimiter. */
-        explicit parser(std::istream& input, char delim)
-            : _source{input}, _delim{delim}
-        {
         }
 
-        /** Skips comment and empty lines, if any. */
-        void skip_comment(char prefix)
+        ~writer()
         {
-            for (;;) {
-                std::string_view line;
-
-                if (auto maybe_line = _source.peek()) {
-                    line = *maybe_line;
-                } else {
-                    break;
-                }
-
-                if (line.empty() || line.front() == prefix) {
-                    _source.consume();
-                } else {
-                    break;
-                }
+            try {
+                flush();
+            } catch (...) {
+                // Destructor must not throw.
             }
         }
 
+        writer(writer const&) = delete;
+        writer& operator=(writer const&) = delete;
+
         /**
-         * Parses the next line as textual fields. The fields are appended to
-         * the end of the vector. Returns true on success or false on reaching
-         * EOF.
+         * Writes a record as a line. Throws tsv::format_error if a text field
+         * contains the delimiter or a newline; nothing is written then.
          */
-        bool parse_fields(std::vector<std::string>& fields)
+        void write(Record const& record)
         {
-            std::string_view line;
-
-            if (auto maybe_line = _source.consume()) {
-                line = *maybe_line;
-            } else {
-                return false;
+            auto const start = _buffer.size();
+            try {
+                detail::format_record(
+                    record,
+                    _delim,
+                    _buffer,
+                    detail::field_type_list<Record>{},
+                    std::make_index_sequence<detail::record_size_v<Record>>{},
+                    _context
+                );
+            } catch (...) {
+                _buffer.resize(start);
+                throw;
             }
 
-            if (auto remain = line; !remain.empty()) {
-                std::string_view field;
-                do {
-                    field = detail::split_consume(remain, _delim);
-                    fields.push_back(std::string{field});
-                } while (field.end() != remain.end());
+            if (_buffer.size() >= block_size) {
+                flush();
             }
-
-            return true;
         }
 
         /**
-         * Parses the next line as a structure. The fields are parsed and
-         * assigned to the members of the given structure object. Returns true
-         * on success or false on reaching EOF.
+         * Writes the buffered lines to the stream. Throws tsv::io_error if
+         * the stream fails.
          */
-        template<typename Record>
-        bool parse_record(Record& record)
+        void flush()
         {
-            std::string_view line;
+            if (_buffer.empty()) {
+                return;
+            }
 
-            if (auto maybe_line = _source.consume()) {
-                line = *maybe_line;
-            } else {
-                return false;
+            auto const buf = _output.rdbuf();
+            if (!_output || !buf) {
+                throw tsv::io_error{tsv::io_error::unknown};
             }
 
+            auto const size = static_cast<std::streamsize>(_buffer.size());
+
+            std::streamsize count;
             try {
-                detail::field_type_list<Record> field_types;
-                record = detail::parse_record<Record>(line, _delim, field_types);
-            } catch (tsv::error& err) {
-                err.line = line;
-                err.line_number = _source.line_number();
-                throw;
+                count = buf->sputn(_buffer.data(), size);
+            } catch (...) {
+                count = -1;
             }
+            _buffer.clear();
 
-            return true;
+            if (count != size) {
+                _output.setstate(std::ios::badbit);
+                throw tsv::io_error{tsv::io_error::unknown};
+            }
         }
 
     private:
-        detail::line_reader _source;
+        std::ostream& _output;
         char const _delim;
+        detail::parse_context const _context;
+        std::string _buffer;
     };
-}
-
-// VALIDATION ----------------------------------------------------------------
 
-namespace tsv::detail
-{
-    /** Validates the values assigned to the fields of a record. */
-    template<
-        typename Record,
-        typename = decltype(std::declval<Record const&>().validate())
-    >
-    void validate(Record const& record)
+    /**
+     * Writes records to a stream as tab-separated values. See `tsv::writer`
+     * for the options.
+     *
+     * @param output is the stream to write to.
+     * @param records is a range of records.
+     * @param opts control how the records are written.
+     */
+    template<typename Range>
+    void dump(std::ostream& output, Range const& records, tsv::options const& opts = {})
     {
-        record.validate();
+        using std::begin;
+        using record_type = std::remove_cv_t<
+            std::remove_reference_t<decltype(*begin(records))>
+        >;
+
+        tsv::writer<record_type> writer{output, opts};
+        for (auto const& record : records) {
+            writer.write(record);
+        }
+        writer.flush();
     }
 
-    template<typename Record, typename... Dummy>
-    void validate(Record const&, Dummy...)
+    template<typename Range>
+    void dump(std::ostream&& output, Range const& records, tsv::options const& opts = {})
     {
+        tsv::dump(output, records, opts);
     }
 }
 
-namespace tsv
-{
-    template<typename Record>
-    std::vector<Record> load(std::istream& input, tsv::options const& opts)
-    {
-        std::vector<Record> records;
-        detail::parser parser{input, opts.delimiter};
-
-        parser.skip_comment(opts.comment);
-
-        if (opts.header) {
-            std::vector<std::string> header;
-            if (!parser.parse_fields(header)) {
-                throw tsv::format_error{tsv::format_error::missing_header};
-            }
-        }
-
-        for (;;) {
-            parser.skip_comment(opts.comment);
+// EXPLICIT INSTANTIATION ----------------------------------------------------
 
-            Record record;
-            if (!parser.parse_record<Record>(record)) {
-                break;
-            }
-            detail::validate(record);
+/**
+ * Declares that the readers and the loaders of a record type are compiled in
+ * another translation unit, which uses TSV_INSTANTIATE_RECORD. This saves
+ * the compile time of the parser of a record type used in many translation
+ * units. The record type must not have string_view fields.
+ *
+ * ```
+ * // my_record.hpp
+ * TSV_EXTERN_RECORD(my_record);
+ *
+ * // my_record.cc
+ * TSV_INSTANTIATE_RECORD(my_record);
+ * ```
+ */
+#define TSV_EXTERN_RECORD(Record) \
+    TSV_RECORD_TEMPLATES(extern template, Record)
 
-            records.push_back(std::move(record));
-        }
+#define TSV_INSTANTIATE_RECORD(Record) \
+    TSV_RECORD_TEMPLATES(template, Record)
 
-        return records;
-    }
-}
+#define TSV_RECORD_TEMPLATES(Prefix, Record)                                 \
+    Prefix class tsv::basic_reader<Record, tsv::detail::line_reader>;         \
+    Prefix class tsv::basic_reader<Record, tsv::detail::file_line_reader>;    \
+    Prefix std::vector<Record> tsv::load<Record>(                             \
+        std::istream&, tsv::options const&                                    \
+    );                                                                        \
+    Prefix std::vector<Record> tsv::load_file<Record>(                        \
+        std::filesystem::path const&, tsv::options const&                     \
+    )
 
 #endif
@@ -0,0 +1,117 @@
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <doctest.h>
+#include <tsv.hpp>
+
+
+namespace
+{
+    struct record_type
+    {
+        int id;
+        double value;
+    };
+
+    std::string make_input(int count)
+    {
+        std::string text = "id\tvalue\n";
+        for (int i = 0; i < count; i++) {
+            text += std::to_string(i);
+            text += "\t0.5\n";
+        }
+        return text;
+    }
+}
+
+TEST_CASE("span - views contiguous objects")
+{
+    std::vector<int> const values = {1, 2, 3};
+    tsv::span<int const> const view{values.data(), values.size()};
+
+    CHECK(view.size() == 3);
+    CHECK_FALSE(view.empty());
+    CHECK(view[1] == 2);
+    CHECK(std::vector<int>(view.begin(), view.end()) == values);
+    CHECK(tsv::span<int>{}.empty());
+}
+
+TEST_CASE("for_each_batch - passes records in batches")
+{
+    std::vector<std::size_t> sizes;
+    std::vector<int> ids;
+
+    tsv::for_each_batch<record_type>(
+        std::istringstream{make_input(10000)}, {}, 4096,
+        [&](tsv::span<record_type const> batch) {
+            sizes.push_back(batch.size());
+            for (auto const& record : batch) {
+                ids.push_back(record.id);
+            }
+        }
+    );
+
+    CHECK(sizes == std::vector<std::size_t>{4096, 4096, 1808});
+
+    bool ordered = ids.size() == 10000;
+    for (std::size_t i = 0; ordered && i < ids.size(); i++) {
+        ordered = ids[i] == static_cast<int>(i);
+    }
+    CHECK(ordered);
+}
+
+TEST_CASE("for_each_batch - propagates errors")
+{
+    auto const callback = [](tsv::span<record_type const>) {};
+
+    SUBCASE("invalid batch size")
+    {
+        CHECK_THROWS_AS(
+            tsv::for_each_batch<record_type>(
+                std::istringstream{make_input(10)}, {}, 0, callback
+            ),
+            std::invalid_argument
+        );
+    }
+
+    SUBCASE("parse error after some batches")
+    {
+        auto text = make_input(1000);
+        text += "x\t0.5\n";
+
+        std::size_t count = 0;
+
+        try {
+            tsv::for_each_batch<record_type>(
+                std::istringstream{text}, {}, 100,
+                [&](tsv::span<record_type const> batch) {
+                    count += batch.size();
+                }
+            );
+            FAIL("exception is not thrown");
+        } catch (tsv::parse_error const& err) {
+            CHECK(err.line_number == 1002);
+        }
+        CHECK(count == 1000);
+    }
+
+    SUBCASE("callback error")
+    {
+        std::size_t calls = 0;
+
+        CHECK_THROWS_AS(
+            tsv::for_each_batch<record_type>(
+                std::istringstream{make_input(1000)}, {}, 10,
+                [&](tsv::span<record_type const>) {
+                    if (++calls == 3) {
+                        throw std::runtime_error{"stop"};
+                    }
+                }
+            ),
+            std::runtime_error
+        );
+        CHECK(calls == 3);
+    }
+}
@@ -1,3 +1,6 @@
+#include <charconv>
+#include <cmath>
+#include <string>
 #include <string_view>
 #include <vector>
 
@@ -147,3 +150,92 @@ TEST_CASE("conversion - parses string token")
         }
     }
 }
+
+TEST_CASE("conversion - integer parser agrees with std::from_chars")
+{
+    std::vector<std::string> const examples = {
+        "0", "00", "007", "1", "-1", "-0", "+1", "-", "", " 1", "1 ",
+        "127", "128", "-128", "-129", "255", "256",
+        "32767", "32768", "-32768", "-32769", "65535", "65536",
+        "2147483647", "2147483648", "-2147483648", "-2147483649",
+        "4294967295", "4294967296",
+        "12345678", "123456789", "1234567890123456", "12345678901234567",
+        "9223372036854775807", "9223372036854775808",
+        "-9223372036854775808", "-9223372036854775809",
+        "18446744073709551615", "18446744073709551616",
+        "99999999999999999999", "000000000000000000000000001",
+        "123x", "1234567x9", "12345678x", "999999999999999999999x",
+    };
+
+    auto check = [&](auto dummy) {
+        using value_type = decltype(dummy);
+
+        for (auto const& text : examples) {
+            auto const begin = text.data();
+            auto const end = text.data() + text.size();
+
+            value_type expected = 0;
+            value_type actual = 0;
+            auto const expected_result = std::from_chars(begin, end, expected);
+            auto const actual_result = tsv::detail::parse_integer(begin, end, actual);
+
+            INFO("text = \"", text, "\"");
+            CHECK(actual_result.ec == expected_result.ec);
+            CHECK(actual_result.ptr == expected_result.ptr);
+            if (expected_result.ec == std::errc{}) {
+                CHECK(actual == expected);
+            }
+        }
+    };
+
+    check(static_cast<signed char>(0));
+    check(static_cast<unsigned char>(0));
+    check(short{});
+    check(static_cast<unsigned short>(0));
+    check(int{});
+    check(unsigned{});
+    check(long{});
+    check(static_cast<unsigned long>(0));
+    check(static_cast<long long>(0));
+    check(static_cast<unsigned long long>(0));
+}
+
+TEST_CASE("conversion - floating-point parser agrees with std::from_chars")
+{
+    std::vector<std::string> const examples = {
+        "0", "-0", "0.0", "1", "-1", "0.1", "-0.1", ".5", "5.", ".", "-.",
+        "1e5", "1E5", "1e+5", "1e-5", "1e", "1e+", "1.5e3x",
+        "123.456", "0.000123", "9007199254740992", "9007199254740993",
+        "1e22", "1e23", "1e-22", "1e-23", "3.14159265358979323846",
+        "12345678901234567890", "1234567890123456789.5",
+        "1e400", "1e-400", "inf", "-inf", "nan", "infinity",
+        "0x10", "1.5\t2", "1.5x", "1.5-", "", "-", "+1", "e5",
+        "0.30000000000000004", "2.2250738585072014e-308",
+        "1.7976931348623157e308", "4.9e-324",
+    };
+
+    auto check = [&](auto dummy) {
+        using value_type = decltype(dummy);
+
+        for (auto const& text : examples) {
+            auto const begin = text.data();
+            auto const end = text.data() + text.size();
+
+            value_type expected = 0;
+            value_type actual = 0;
+            auto const expected_result = std::from_chars(begin, end, expected);
+            auto const actual_result = tsv::detail::parse_float(begin, end, actual);
+
+            INFO("text = \"", text, "\"");
+            CHECK(actual_result.ec == expected_result.ec);
+            CHECK(actual_result.ptr == expected_result.ptr);
+            if (expected_result.ec == std::errc{} && expected == expected) {
+                CHECK(actual == expected);
+                CHECK(std::signbit(actual) == std::signbit(expected));
+            }
+        }
+    };
+
+    check(float{});
+    check(double{});
+}
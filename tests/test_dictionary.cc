@@ -0,0 +1,83 @@
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <doctest.h>
+#include <tsv.hpp>
+
+
+TEST_CASE("dictionary - assigns codes to distinct strings")
+{
+    tsv::dictionary dict;
+
+    CHECK(dict.intern("foo") == 0);
+    CHECK(dict.intern("bar") == 1);
+    CHECK(dict.intern("foo") == 0);
+    CHECK(dict.intern("") == 2);
+
+    CHECK(dict.size() == 3);
+    CHECK(dict[0] == "foo");
+    CHECK(dict[1] == "bar");
+    CHECK(dict[2] == "");
+
+    CHECK(dict.find("bar") == 1);
+    CHECK(dict.find("baz") == std::nullopt);
+}
+
+TEST_CASE("load - interns text fields")
+{
+    struct country_tag {};
+    struct status_tag {};
+
+    struct record_type
+    {
+        int id;
+        tsv::interned<country_tag> country;
+        tsv::interned<status_tag> status;
+    };
+
+    std::string const text =
+        "id\tcountry\tstatus\n"
+        "1\tUS\tok\n"
+        "2\tJP\tok\n"
+        "3\tUS\tng\n";
+
+    SUBCASE("sequential")
+    {
+        tsv::dictionary dict;
+        tsv::options opts;
+        opts.dictionary = &dict;
+
+        auto const records = tsv::load<record_type>(std::istringstream{text}, opts);
+
+        CHECK(records.size() == 3);
+        CHECK(dict.size() == 4);
+        CHECK(dict[records.at(0).country.code] == "US");
+        CHECK(dict[records.at(1).country.code] == "JP");
+        CHECK(dict[records.at(0).status.code] == "ok");
+        CHECK(dict[records.at(2).status.code] == "ng");
+        CHECK(records.at(0).country == records.at(2).country);
+        CHECK(records.at(0).status == records.at(1).status);
+    }
+
+    SUBCASE("parallel")
+    {
+        tsv::dictionary dict;
+        tsv::options opts;
+        opts.dictionary = &dict;
+
+        auto const records = tsv::parallel_load<record_type>(text, opts, 2);
+
+        CHECK(records.size() == 3);
+        CHECK(dict.size() == 4);
+        CHECK(dict[records.at(0).country.code] == "US");
+        CHECK(dict[records.at(2).status.code] == "ng");
+    }
+
+    SUBCASE("dictionary is required")
+    {
+        CHECK_THROWS_AS(
+            tsv::load<record_type>(std::istringstream{text}), std::invalid_argument
+        );
+    }
+}
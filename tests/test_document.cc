@@ -0,0 +1,81 @@
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include <doctest.h>
+#include <tsv.hpp>
+
+
+namespace
+{
+    struct record_type
+    {
+        std::string_view id;
+        int value;
+    };
+
+    bool refers_to(std::string_view view, std::string_view text)
+    {
+        return view.data() >= text.data() &&
+               view.data() + view.size() <= text.data() + text.size();
+    }
+}
+
+TEST_CASE("conversion - parses string view")
+{
+    std::string_view const text = "abc";
+    CHECK(tsv::conversion<std::string_view>::parse(text).data() == text.data());
+}
+
+TEST_CASE("document - loads records referring to stream content")
+{
+    std::istringstream input{
+        "id\tvalue\n"
+        "foo\t1\n"
+        "bar\t2\n"
+    };
+
+    auto doc = tsv::load_document<record_type>(input);
+
+    CHECK(doc.size() == 2);
+    CHECK(doc[0].id == "foo");
+    CHECK(doc[0].value == 1);
+    CHECK(doc[1].id == "bar");
+    CHECK(doc[1].value == 2);
+
+    // Views stay valid after moving the document.
+    auto const moved = std::move(doc);
+    CHECK(moved[0].id == "foo");
+    CHECK(refers_to(moved[0].id, moved.text()));
+    CHECK(refers_to(moved[1].id, moved.text()));
+}
+
+TEST_CASE("document - loads records referring to file content")
+{
+    auto const path =
+        std::filesystem::temp_directory_path() / "tsv-test-document.tsv";
+    {
+        std::ofstream file{path, std::ios::binary};
+        file << "id\tvalue\nfoo\t1\nbar\t2\n";
+    }
+
+    {
+        auto const doc = tsv::load_file_document<record_type>(path);
+
+        CHECK(doc.size() == 2);
+        CHECK(doc[0].id == "foo");
+        CHECK(doc[1].id == "bar");
+        CHECK(refers_to(doc[1].id, doc.text()));
+
+        int sum = 0;
+        for (auto const& record : doc) {
+            sum += record.value;
+        }
+        CHECK(sum == 3);
+    }
+
+    std::filesystem::remove(path);
+}
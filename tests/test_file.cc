@@ -0,0 +1,568 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <doctest.h>
+#include <tsv.hpp>
+
+
+namespace
+{
+    // Temporary file that is removed on destruction.
+    class temporary_file
+    {
+    public:
+        explicit temporary_file(std::string const& content)
+            : _path{
+                std::filesystem::temp_directory_path() /
+                ("tsv-test-" + std::to_string(counter++) + ".tsv")
+            }
+        {
+            std::ofstream file{_path, std::ios::binary};
+            file << content;
+        }
+
+        ~temporary_file()
+        {
+            std::error_code ec;
+            std::filesystem::remove(_path, ec);
+        }
+
+        std::filesystem::path const& path() const
+        {
+            return _path;
+        }
+
+    private:
+        static inline int counter = 0;
+        std::filesystem::path _path;
+    };
+}
+
+TEST_CASE("memory_reader - reads lines from text")
+{
+    using tsv::detail::memory_reader;
+
+    memory_reader reader{"first line\n\nlast line"};
+
+    CHECK(reader.peek() == "first line");
+    CHECK(reader.consume() == "first line");
+    CHECK(reader.consume() == "");
+    CHECK(reader.consume() == "last line");
+    CHECK(reader.consume() == std::nullopt);
+    CHECK(reader.peek() == std::nullopt);
+    CHECK(reader.line_number() == 3);
+}
+
+TEST_CASE("mapped_file - reads file content")
+{
+    SUBCASE("non-empty file")
+    {
+        temporary_file file{"abc\ndef\n"};
+        tsv::detail::mapped_file mapped{file.path()};
+        CHECK(mapped.view() == "abc\ndef\n");
+    }
+
+    SUBCASE("empty file")
+    {
+        temporary_file file{""};
+        tsv::detail::mapped_file mapped{file.path()};
+        CHECK(mapped.view().empty());
+    }
+
+    SUBCASE("missing file")
+    {
+        CHECK_THROWS_AS(
+            tsv::detail::mapped_file{"/nonexistent/tsv-test.tsv"}, tsv::io_error
+        );
+    }
+}
+
+TEST_CASE("load_file - parses valid tsv file")
+{
+    struct record_type
+    {
+        unsigned row;
+        unsigned column;
+        double value;
+    };
+
+    temporary_file file{
+        "row\tcolumn\tvalue\n"
+        "1\t2\t1.23\n"
+        "3\t4\t4.56\n"
+    };
+
+    auto const records = tsv::load_file<record_type>(file.path());
+
+    CHECK(records.size() == 2);
+    CHECK(records.at(0).row == 1);
+    CHECK(records.at(0).column == 2);
+    CHECK(records.at(0).value == doctest::Approx(1.23));
+    CHECK(records.at(1).row == 3);
+    CHECK(records.at(1).column == 4);
+    CHECK(records.at(1).value == doctest::Approx(4.56));
+}
+
+TEST_CASE("load_file_into - reserves estimated rows")
+{
+    struct record_type
+    {
+        int id;
+        double value;
+    };
+
+    std::string content = "id\tvalue\n";
+    for (int i = 0; i < 20000; i++) {
+        content += std::to_string(i) + "\t0.25\n";
+    }
+    temporary_file file{content};
+
+    std::vector<record_type> records;
+    tsv::load_file_into(records, file.path());
+
+    REQUIRE(records.size() == 20000);
+    CHECK(records.back().id == 19999);
+
+    // The estimate is enough for the input, so no reallocation is needed.
+    auto const data = records.data();
+    tsv::load_file_into(records, file.path());
+
+    CHECK(records.size() == 20000);
+    CHECK(records.data() == data);
+
+    // The skipped header is counted as in load_file.
+    tsv::load_stats stats;
+    tsv::options opts;
+    opts.stats = &stats;
+    tsv::load_file_into(records, file.path(), opts);
+
+    CHECK(stats.lines == 20001);
+    CHECK(stats.bytes == content.size());
+    CHECK(stats.rows == 20000);
+
+    CHECK(tsv::detail::estimate_lines("") == 0);
+    CHECK(tsv::detail::estimate_lines("a\nb\n") == 3);
+}
+
+TEST_CASE("file_reader - reports error line")
+{
+    struct record_type
+    {
+        int value;
+    };
+
+    temporary_file file{"value\n1\nx\n"};
+    tsv::file_reader<record_type> reader{file.path()};
+
+    record_type record;
+    CHECK(reader.read(record));
+    CHECK(record.value == 1);
+
+    try {
+        reader.read(record);
+        FAIL("exception is not thrown");
+    } catch (tsv::parse_error const& err) {
+        CHECK(err.line_number == 3);
+        CHECK(err.line == "x");
+    }
+}
+
+#if TSV_ENABLE_ZLIB
+namespace
+{
+    // Compresses text into a gzip member. The member is made BGZF-compliant
+    // if bgzf is true.
+    std::string gzip(std::string_view text, bool bgzf = false)
+    {
+        z_stream stream = {};
+        REQUIRE(deflateInit2(&stream, 6, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) == Z_OK);
+
+        std::string body(deflateBound(&stream, static_cast<uLong>(text.size())), '\0');
+        stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(text.data()));
+        stream.avail_in = static_cast<uInt>(text.size());
+        stream.next_out = reinterpret_cast<Bytef*>(body.data());
+        stream.avail_out = static_cast<uInt>(body.size());
+        REQUIRE(deflate(&stream, Z_FINISH) == Z_STREAM_END);
+        body.resize(stream.total_out);
+        deflateEnd(&stream);
+
+        auto const append_le = [](std::string& out, std::size_t value, int bytes) {
+            for (int i = 0; i < bytes; i++) {
+                out += static_cast<char>(value >> (8 * i) & 0xff);
+            }
+        };
+
+        std::string member = "\x1f\x8b\x08";
+        member += bgzf ? '\x04' : '\x00';
+        member += std::string(4, '\0');
+        member += std::string_view{"\x00\xff", 2};
+        if (bgzf) {
+            append_le(member, 6, 2);
+            member += "BC";
+            append_le(member, 2, 2);
+            append_le(member, 12 + 6 + body.size() + 8 - 1, 2);
+        }
+        member += body;
+
+        auto const crc = crc32(
+            0, reinterpret_cast<Bytef const*>(text.data()), static_cast<uInt>(text.size())
+        );
+        append_le(member, crc, 4);
+        append_le(member, text.size(), 4);
+
+        return member;
+    }
+}
+#endif
+
+TEST_CASE("detect_compression - detects compression by magic bytes")
+{
+    using tsv::detail::compression;
+    using tsv::detail::detect_compression;
+
+    CHECK(detect_compression("id\tvalue\n") == compression::none);
+    CHECK(detect_compression("") == compression::none);
+    CHECK(detect_compression("\x1f\x8b\x08") == compression::gzip);
+    CHECK(detect_compression("\x28\xb5\x2f\xfd") == compression::zstd);
+}
+
+TEST_CASE("load_file - decompresses compressed file")
+{
+    struct record_type
+    {
+        int id;
+        std::string name;
+    };
+
+    std::string text = "id\tname\n";
+    for (int i = 0; i < 5000; i++) {
+        text += std::to_string(i) + "\tname" + std::to_string(i % 7) + "\n";
+    }
+
+#if TSV_ENABLE_ZLIB
+    // Split the text into several members.
+    auto const split = [&](bool bgzf) {
+        std::string data;
+        for (std::size_t pos = 0; pos < text.size(); pos += 10000) {
+            data += gzip(std::string_view{text}.substr(pos, 10000), bgzf);
+        }
+        if (bgzf) {
+            data += gzip("", true);
+        }
+        return data;
+    };
+
+    for (bool const bgzf : {false, true}) {
+        INFO("bgzf = ", bgzf);
+
+        temporary_file file{split(bgzf)};
+        auto const records = tsv::load_file<record_type>(file.path());
+
+        REQUIRE(records.size() == 5000);
+        CHECK(records.back().id == 4999);
+        CHECK(records.back().name == "name1");
+    }
+
+    SUBCASE("corrupt input")
+    {
+        for (bool const bgzf : {false, true}) {
+            auto data = split(bgzf);
+            data[100] = static_cast<char>(data[100] ^ 0x55);
+            temporary_file file{data};
+            CHECK_THROWS_AS(tsv::load_file<record_type>(file.path()), tsv::io_error);
+        }
+    }
+
+    SUBCASE("truncated input")
+    {
+        auto data = gzip(text);
+        data.resize(data.size() / 2);
+        temporary_file file{data};
+        CHECK_THROWS_AS(tsv::load_file<record_type>(file.path()), tsv::io_error);
+    }
+#else
+    temporary_file file{"\x1f\x8b\x08\x00" + text};
+
+    try {
+        tsv::load_file<record_type>(file.path());
+        FAIL("exception is not thrown");
+    } catch (tsv::io_error const& err) {
+        CHECK(err.what() == std::string{tsv::io_error::unsupported_compression});
+    }
+#endif
+}
+
+TEST_CASE("load_file - uses binary cache")
+{
+    struct plain_record
+    {
+        int id;
+        double value;
+    };
+
+    struct text_record
+    {
+        int id;
+        std::string name;
+    };
+
+    temporary_file file{"id\tvalue\n1\t0.5\n2\t1.5\n"};
+
+    auto const cache = std::filesystem::path{file.path()}.concat(".cache");
+    auto const time = std::filesystem::last_write_time(file.path());
+
+    // Rewrites the file keeping its size and modification time, so that the
+    // cache looks fresh.
+    auto const tamper = [&](std::string const& content) {
+        std::ofstream{file.path(), std::ios::binary} << content;
+        std::filesystem::last_write_time(file.path(), time);
+    };
+
+    tsv::options opts;
+    opts.cache = cache;
+
+    SUBCASE("trivially copyable record")
+    {
+        auto const first = tsv::load_file<plain_record>(file.path(), opts);
+        REQUIRE(first.size() == 2);
+        CHECK(std::filesystem::exists(cache));
+
+        tamper("id\tvalue\n3\t2.5\n4\t3.5\n");
+
+        auto const cached = tsv::load_file<plain_record>(file.path(), opts);
+        REQUIRE(cached.size() == 2);
+        CHECK(cached[1].id == 2);
+        CHECK(cached[1].value == 1.5);
+
+        // Different options invalidate the cache.
+        opts.header = false;
+        CHECK_THROWS_AS(tsv::load_file<plain_record>(file.path(), opts), tsv::parse_error);
+        opts.header = true;
+
+        // So does modification time.
+        std::filesystem::last_write_time(file.path(), time + std::chrono::seconds{1});
+        auto const reloaded = tsv::load_file<plain_record>(file.path(), opts);
+        REQUIRE(reloaded.size() == 2);
+        CHECK(reloaded[1].id == 4);
+    }
+
+    SUBCASE("record with strings")
+    {
+        tamper("id\tname\n1\tfoo\n2\t\n");
+
+        auto const first = tsv::load_file<text_record>(file.path(), opts);
+        REQUIRE(first.size() == 2);
+
+        tamper("id\tname\n3\tbar\n4\t\n");
+
+        auto const cached = tsv::load_file<text_record>(file.path(), opts);
+        REQUIRE(cached.size() == 2);
+        CHECK(cached[0].id == 1);
+        CHECK(cached[0].name == "foo");
+        CHECK(cached[1].name == "");
+    }
+
+    SUBCASE("escaping invalidates the cache")
+    {
+        tamper("id\tname\n1\ta\\tb\n");
+
+        auto const raw = tsv::load_file<text_record>(file.path(), opts);
+        REQUIRE(raw.size() == 1);
+        CHECK(raw[0].name == "a\\tb");
+
+        opts.escaping = tsv::escaping::backslash;
+
+        auto const unescaped = tsv::load_file<text_record>(file.path(), opts);
+        REQUIRE(unescaped.size() == 1);
+        CHECK(unescaped[0].name == "a\tb");
+    }
+
+    SUBCASE("corrupt cache")
+    {
+        tsv::load_file<plain_record>(file.path(), opts);
+        std::filesystem::resize_file(cache, 70);
+
+        auto const records = tsv::load_file<plain_record>(file.path(), opts);
+        REQUIRE(records.size() == 2);
+        CHECK(records[0].id == 1);
+        CHECK(std::filesystem::file_size(cache) > 70);
+    }
+
+    SUBCASE("corrupt record count")
+    {
+        tamper("id\tname\n1\tfoo\n2\t\n");
+        tsv::load_file<text_record>(file.path(), opts);
+
+        // Overwrite the count in the cache header with a huge number.
+        {
+            std::fstream stream{cache, std::ios::in | std::ios::out | std::ios::binary};
+            std::uint64_t const count = std::uint64_t(1) << 60;
+            stream.seekp(48);
+            stream.write(reinterpret_cast<char const*>(&count), sizeof count);
+        }
+
+        auto const records = tsv::load_file<text_record>(file.path(), opts);
+        REQUIRE(records.size() == 2);
+        CHECK(records[0].name == "foo");
+    }
+
+    SUBCASE("corrupt boolean")
+    {
+        struct flag_record
+        {
+            int id;
+            bool flag;
+        };
+        static_assert(!tsv::detail::is_raw_cacheable_v<flag_record>);
+
+        enum class scoped : std::uint8_t {};
+        enum unscoped {};
+        static_assert(tsv::detail::is_cacheable_field_v<scoped>);
+        static_assert(!tsv::detail::is_raw_field_v<scoped>);
+        static_assert(!tsv::detail::is_cacheable_field_v<unscoped>);
+
+        tamper("id\tflag\n1\t1\n2\t0\n");
+        tsv::load_file<flag_record>(file.path(), opts);
+
+        tamper("id\tflag\n3\t1\n4\t0\n");
+
+        // Overwrite the flag of the second record with an invalid byte.
+        {
+            std::fstream stream{cache, std::ios::in | std::ios::out | std::ios::binary};
+            stream.seekp(sizeof(tsv::detail::cache_header) + 9);
+            stream.put('\x02');
+        }
+
+        auto const records = tsv::load_file<flag_record>(file.path(), opts);
+        REQUIRE(records.size() == 2);
+        CHECK(records[0].id == 3);
+        CHECK(records[1].flag == false);
+    }
+
+    std::error_code ec;
+    std::filesystem::remove(cache, ec);
+}
+
+TEST_CASE("load_files - loads multiple files in order")
+{
+    struct record_type
+    {
+        int id;
+        std::string name;
+    };
+
+    std::vector<temporary_file> files;
+    files.reserve(3);
+    files.emplace_back("id\tname\n1\tfoo\n2\tbar\n");
+    files.emplace_back("name\tid\n# comment\nbaz\t3\n");
+    files.emplace_back("id\tname\n" + std::string(1000, '\n'));
+
+    std::vector<std::filesystem::path> const paths = {
+        files[0].path(), files[1].path(), files[2].path()
+    };
+
+    tsv::options opts;
+    opts.column_names = {"id", "name"};
+    opts.comment = '#';
+
+    SUBCASE("concatenated") {
+        auto const records = tsv::load_files<record_type>(paths, opts, 2);
+
+        REQUIRE(records.size() == 3);
+        CHECK(records[0].id == 1);
+        CHECK(records[1].name == "bar");
+        CHECK(records[2].id == 3);
+        CHECK(records[2].name == "baz");
+    }
+
+    SUBCASE("per file") {
+        auto const shards = tsv::load_shards<record_type>(paths, opts, 2);
+
+        REQUIRE(shards.size() == 3);
+        CHECK(shards[0].size() == 2);
+        CHECK(shards[1].size() == 1);
+        CHECK(shards[2].empty());
+    }
+
+    SUBCASE("errors report the file") {
+        temporary_file bad{"id\tname\n1\tfoo\nx\tbar\n"};
+        std::vector<std::filesystem::path> const bad_paths = {
+            files[0].path(), bad.path()
+        };
+
+        try {
+            tsv::load_files<record_type>(bad_paths, opts, 2);
+            FAIL("error is not thrown");
+        } catch (tsv::parse_error const& err) {
+            CHECK(err.source == bad.path().string());
+            CHECK(err.line_number == 3);
+            auto const location = "(in " + bad.path().string() + " at line 3)";
+            CHECK(err.describe().find(location) != std::string::npos);
+        }
+
+        std::vector<tsv::error> rejected;
+        opts.on_error = tsv::error_policy::collect;
+        opts.rejected = &rejected;
+
+        auto const records = tsv::load_files<record_type>(bad_paths, opts, 2);
+
+        CHECK(records.size() == 3);
+        REQUIRE(rejected.size() == 1);
+        CHECK(rejected[0].source == bad.path().string());
+        CHECK(rejected[0].line_number == 3);
+    }
+}
+
+TEST_CASE("tail_reader - reads appended lines")
+{
+    struct record_type
+    {
+        int id;
+        std::string name;
+    };
+
+    temporary_file file{"# log\nname\tid\n"};
+    std::ofstream writer{file.path(), std::ios::binary | std::ios::app};
+
+    std::vector<tsv::error> rejected;
+
+    tsv::options opts;
+    opts.column_names = {"id", "name"};
+    opts.comment = '#';
+    opts.on_error = tsv::error_policy::collect;
+    opts.rejected = &rejected;
+
+    tsv::tail_reader<record_type> tail{file.path(), opts};
+    std::vector<record_type> records;
+
+    CHECK(tail.poll(records) == 0);
+    CHECK(tail.header() == std::vector<std::string>{"name", "id"});
+    CHECK(tail.line_number() == 2);
+    CHECK(tail.offset() == 14);
+
+    writer << "foo\t1\nbar\t" << std::flush;
+
+    CHECK(tail.poll(records) == 1);
+    CHECK(tail.line_number() == 3);
+    CHECK(tail.offset() == 20);
+
+    writer << "2\nbaz\tx\n" << std::flush;
+
+    CHECK(tail.poll(records) == 1);
+    CHECK(tail.poll(records) == 0);
+    CHECK(tail.line_number() == 5);
+
+    REQUIRE(records.size() == 2);
+    CHECK(records[0].name == "foo");
+    CHECK(records[1].id == 2);
+    CHECK(records[1].name == "bar");
+
+    REQUIRE(rejected.size() == 1);
+    CHECK(rejected[0].line_number == 5);
+}
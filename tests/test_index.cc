@@ -0,0 +1,282 @@
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <doctest.h>
+#include <tsv.hpp>
+
+
+namespace
+{
+    struct record_type
+    {
+        int id;
+        std::string name;
+    };
+
+    // Temporary file that is removed on destruction.
+    class temporary_file
+    {
+    public:
+        explicit temporary_file(std::string const& content)
+            : _path{
+                std::filesystem::temp_directory_path() /
+                ("tsv-index-test-" + std::to_string(counter++) + ".tsv")
+            }
+        {
+            std::ofstream file{_path, std::ios::binary};
+            file << content;
+        }
+
+        ~temporary_file()
+        {
+            std::error_code ec;
+            std::filesystem::remove(_path, ec);
+        }
+
+        std::filesystem::path const& path() const
+        {
+            return _path;
+        }
+
+    private:
+        std::filesystem::path _path;
+        static inline int counter = 0;
+    };
+
+    std::string make_input(int count)
+    {
+        std::string text = "# leading comment\nid\tname\n";
+        for (int i = 0; i < count; i++) {
+            text += std::to_string(i);
+            text += "\tname";
+            text += std::to_string(i);
+            text += '\n';
+            if (i % 7 == 0) {
+                text += "# comment\n\n";
+            }
+        }
+        return text;
+    }
+}
+
+TEST_CASE("index - records checkpoints of rows")
+{
+    std::string_view const text = "id\n#c\n0\n1\n\n2\n3\n4";
+
+    tsv::options opts;
+    opts.comment = '#';
+
+    tsv::index const index{text, opts, 2};
+
+    CHECK(index.size() == 5);
+    CHECK(index.stride() == 2);
+    CHECK(index.source_size() == text.size());
+
+    auto const& points = index.checkpoints();
+    REQUIRE(points.size() == 3);
+    CHECK(text.substr(points[0].offset, 1) == "0");
+    CHECK(text.substr(points[1].offset, 1) == "2");
+    CHECK(text.substr(points[2].offset, 1) == "4");
+    CHECK(points[0].line_number == 2);
+    CHECK(points[1].line_number == 5);
+    CHECK(points[2].line_number == 7);
+
+    CHECK_THROWS_AS(tsv::index(text, opts, 0), std::invalid_argument);
+    CHECK_THROWS_AS(tsv::index("#c\n", opts), tsv::format_error);
+}
+
+TEST_CASE("read_range - reads rows at any position")
+{
+    auto const text = make_input(1000);
+
+    tsv::options opts;
+    opts.comment = '#';
+    opts.columns = {1, 0};
+
+    tsv::index const index{text, opts, 16};
+
+    struct swapped_record
+    {
+        std::string name;
+        int id;
+    };
+
+    for (std::size_t first : std::vector<std::size_t>{0, 1, 15, 16, 17, 500, 990}) {
+        INFO("first = ", first);
+
+        auto const records = tsv::read_range<swapped_record>(text, index, first, 20, opts);
+
+        CHECK(records.size() == std::min<std::size_t>(20, 1000 - first));
+
+        bool correct = true;
+        for (std::size_t i = 0; i < records.size(); i++) {
+            auto const id = static_cast<int>(first + i);
+            correct = correct && records[i].id == id;
+            correct = correct && records[i].name == "name" + std::to_string(id);
+        }
+        CHECK(correct);
+    }
+
+    CHECK(tsv::read_range<swapped_record>(text, index, 1000, 1, opts).empty());
+    CHECK(tsv::read_range<swapped_record>(text, index, 5000, 1, opts).empty());
+
+    // The index does not describe a modified text.
+    CHECK_THROWS_AS(
+        tsv::read_range<swapped_record>(text + "x", index, 0, 1, opts),
+        std::invalid_argument
+    );
+    CHECK_THROWS_AS(
+        tsv::read_range<swapped_record>(text, index, 0, 1),
+        std::invalid_argument
+    );
+}
+
+TEST_CASE("read_range - reports global line number")
+{
+    auto text = make_input(100);
+
+    // The row with id 50 follows 2 + 50 lines and 8 comment blocks of 2 lines.
+    auto const pos = text.find("\n50\t") + 1;
+    text.replace(pos, 2, "xx");
+
+    tsv::options opts;
+    opts.comment = '#';
+
+    tsv::index const index{text, opts, 16};
+
+    try {
+        tsv::read_range<record_type>(text, index, 40, 20, opts);
+        FAIL("no exception");
+    } catch (tsv::parse_error const& err) {
+        CHECK(err.line_number == 69);
+    }
+
+    std::vector<tsv::error> rejected;
+    opts.on_error = tsv::error_policy::collect;
+    opts.rejected = &rejected;
+
+    auto const records = tsv::read_range<record_type>(text, index, 40, 20, opts);
+
+    CHECK(records.size() == 19);
+    CHECK(records.back().id == 59);
+    REQUIRE(rejected.size() == 1);
+    CHECK(rejected[0].line_number == 69);
+}
+
+TEST_CASE("read_range - stops at the end of the range")
+{
+    std::string const text = "id\tname\n0\ta\nzz\tb\n2\tc\n3\td\n";
+
+    tsv::options opts;
+    tsv::index const index{text, opts, 2};
+
+    SUBCASE("skip") {
+        opts.on_error = tsv::error_policy::skip;
+
+        auto const records = tsv::read_range<record_type>(text, index, 0, 2, opts);
+
+        REQUIRE(records.size() == 1);
+        CHECK(records[0].id == 0);
+    }
+
+    SUBCASE("collect") {
+        std::vector<tsv::error> rejected;
+        opts.on_error = tsv::error_policy::collect;
+        opts.rejected = &rejected;
+
+        auto const records = tsv::read_range<record_type>(text, index, 1, 2, opts);
+
+        REQUIRE(records.size() == 1);
+        CHECK(records[0].id == 2);
+        REQUIRE(rejected.size() == 1);
+        CHECK(rejected[0].line_number == 3);
+    }
+}
+
+TEST_CASE("read_range - filters rows within the range")
+{
+    std::string const text = "id\tname\n0\ta\n1\tbad\n2\tx\n3\tbad\n4\ta\n";
+
+    tsv::options opts;
+    tsv::index const index{text, opts, 2};
+
+    opts.filters = {tsv::equals(1, "a")};
+
+    auto const records = tsv::read_range<record_type>(text, index, 0, 3, opts);
+    REQUIRE(records.size() == 1);
+    CHECK(records[0].id == 0);
+
+    auto const tail = tsv::read_range<record_type>(text, index, 1, 4, opts);
+    REQUIRE(tail.size() == 1);
+    CHECK(tail[0].id == 4);
+}
+
+TEST_CASE("index - saves and loads index file")
+{
+    auto const text = make_input(1000);
+
+    tsv::options opts;
+    opts.comment = '#';
+
+    temporary_file data{text};
+    auto const index = tsv::index_file(data.path(), opts, 64);
+
+    auto index_path = data.path();
+    index_path += ".idx";
+    index.save(index_path);
+
+    auto const loaded = tsv::index::load(index_path);
+
+    CHECK(loaded.size() == index.size());
+    CHECK(loaded.stride() == index.stride());
+    CHECK(loaded.source_size() == index.source_size());
+    REQUIRE(loaded.checkpoints().size() == index.checkpoints().size());
+    CHECK(loaded.checkpoints().back().offset == index.checkpoints().back().offset);
+
+    auto const records = tsv::read_file_range<record_type>(data.path(), loaded, 700, 3, opts);
+    REQUIRE(records.size() == 3);
+    CHECK(records[0].id == 700);
+    CHECK(records[2].name == "name702");
+
+    // Truncated index.
+    std::filesystem::resize_file(index_path, std::filesystem::file_size(index_path) - 1);
+    CHECK_THROWS_AS(tsv::index::load(index_path), tsv::io_error);
+
+    std::filesystem::remove(index_path);
+    CHECK_THROWS_AS(tsv::index::load(index_path), tsv::io_error);
+}
+
+TEST_CASE("parallel_load_file - splits file at index checkpoints")
+{
+    auto const text = make_input(20000);
+
+    tsv::options opts;
+    opts.comment = '#';
+
+    temporary_file data{text};
+    auto const index = tsv::index_file(data.path(), opts, 100);
+
+    for (std::size_t threads : std::vector<std::size_t>{1, 3, 8}) {
+        INFO("threads = ", threads);
+
+        auto const records = tsv::parallel_load_file<record_type>(
+            data.path(), index, opts, threads
+        );
+
+        CHECK(records.size() == 20000);
+
+        bool ordered = true;
+        for (std::size_t i = 0; i < records.size(); i++) {
+            ordered = ordered && records[i].id == static_cast<int>(i);
+        }
+        CHECK(ordered);
+    }
+
+    temporary_file empty{"id\tname\n"};
+    auto const empty_index = tsv::index_file(empty.path(), opts);
+    CHECK(tsv::parallel_load_file<record_type>(empty.path(), empty_index, opts).empty());
+}
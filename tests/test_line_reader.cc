@@ -1,4 +1,6 @@
 #include <sstream>
+#include <string>
+#include <vector>
 
 #include <doctest.h>
 #include <tsv.hpp>
@@ -81,3 +83,86 @@ TEST_CASE("line_reader::line_number - returns the number of lines read")
     CHECK(reader.consume() == std::nullopt);
     CHECK(reader.line_number() == 2);
 }
+
+TEST_CASE("line_reader - stitches lines across block boundaries")
+{
+    using tsv::detail::line_reader;
+
+    std::string const content =
+        "first line\n"
+        "\n"
+        "a much longer line that does not fit in a block\n"
+        "last line without newline";
+
+    for (std::size_t block_size = 1; block_size <= 16; block_size++) {
+        INFO("block_size = ", block_size);
+
+        std::istringstream source{content};
+        line_reader reader{source, block_size};
+
+        CHECK(reader.consume() == "first line");
+        CHECK(reader.consume() == "");
+        CHECK(reader.peek() == "a much longer line that does not fit in a block");
+        CHECK(reader.consume() == "a much longer line that does not fit in a block");
+        CHECK(reader.consume() == "last line without newline");
+        CHECK(reader.consume() == std::nullopt);
+        CHECK(reader.line_number() == 4);
+        CHECK(source.eof());
+    }
+}
+
+TEST_CASE("line_reader - throws on failed stream")
+{
+    using tsv::detail::line_reader;
+
+    std::istringstream source{"line\n"};
+    source.setstate(std::ios::failbit);
+    line_reader reader{source};
+
+    CHECK_THROWS_AS(reader.consume(), tsv::io_error);
+}
+
+TEST_CASE("line_reader - reads ahead on background thread")
+{
+    using tsv::detail::line_reader;
+
+    std::string content;
+    for (int i = 0; i < 10000; i++) {
+        content += "line ";
+        content += std::to_string(i);
+        content += '\n';
+    }
+
+    for (std::size_t block_size : std::vector<std::size_t>{1, 7, 4096}) {
+        INFO("block_size = ", block_size);
+
+        std::istringstream source{content};
+        line_reader reader{source, block_size, true};
+
+        bool ordered = true;
+        for (int i = 0; i < 10000; i++) {
+            ordered = ordered && reader.consume() == "line " + std::to_string(i);
+        }
+        CHECK(ordered);
+        CHECK(reader.consume() == std::nullopt);
+        CHECK(reader.line_number() == 10000);
+        CHECK(source.eof());
+    }
+
+    SUBCASE("failed stream")
+    {
+        std::istringstream source{"line\n"};
+        source.setstate(std::ios::failbit);
+        line_reader reader{source, line_reader::default_block_size, true};
+
+        CHECK_THROWS_AS(reader.consume(), tsv::io_error);
+    }
+
+    SUBCASE("abandoned before the end")
+    {
+        std::istringstream source{content};
+        line_reader reader{source, 16, true};
+
+        CHECK(reader.consume() == "line 0");
+    }
+}
@@ -0,0 +1,162 @@
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <doctest.h>
+#include <tsv.hpp>
+
+
+namespace
+{
+    struct record_type
+    {
+        int id;
+        double value;
+    };
+
+    std::string make_input(int count)
+    {
+        std::string text = "id\tvalue\n";
+        for (int i = 0; i < count; i++) {
+            text += std::to_string(i);
+            text += "\t0.5\n";
+            if (i % 1000 == 0) {
+                text += "# comment\n";
+            }
+        }
+        return text;
+    }
+}
+
+TEST_CASE("split_lines - splits text at line boundaries")
+{
+    using tsv::detail::split_lines;
+
+    std::string_view const text = "aaa\nbbb\nccc\nddd";
+    auto const chunks = split_lines(text, 2);
+
+    CHECK(chunks.size() == 2);
+    CHECK(chunks.at(0) == "aaa\nbbb\n");
+    CHECK(chunks.at(1) == "ccc\nddd");
+
+    CHECK(split_lines("", 4).empty());
+    CHECK(split_lines("abc", 4) == std::vector<std::string_view>{"abc"});
+}
+
+TEST_CASE("parallel_load - loads records in input order")
+{
+    auto const text = make_input(50000);
+
+    tsv::options opts;
+    opts.comment = '#';
+
+    for (std::size_t threads : std::vector<std::size_t>{1, 2, 3, 8}) {
+        INFO("threads = ", threads);
+
+        auto const records = tsv::parallel_load<record_type>(text, opts, threads);
+
+        CHECK(records.size() == 50000);
+
+        bool ordered = true;
+        for (std::size_t i = 0; i < records.size(); i++) {
+            ordered = ordered && records[i].id == static_cast<int>(i);
+        }
+        CHECK(ordered);
+    }
+}
+
+TEST_CASE("parallel_load - reports global line number")
+{
+    auto text = make_input(50000);
+
+    // The record with id 40000 is the 40001st record. It follows the header
+    // line and 40 comment lines.
+    auto const pos = text.find("\n40000\t") + 1;
+    text.replace(pos, 5, "error");
+
+    tsv::options opts;
+    opts.comment = '#';
+
+    try {
+        tsv::parallel_load<record_type>(text, opts, 4);
+        FAIL("exception is not thrown");
+    } catch (tsv::parse_error const& err) {
+        CHECK(err.line_number == 1 + 40 + 40001);
+        CHECK(err.line == "error\t0.5");
+    }
+}
+
+TEST_CASE("parallel_load - requires header")
+{
+    CHECK_THROWS_AS(tsv::parallel_load<record_type>(""), tsv::format_error);
+    CHECK(tsv::parallel_load<record_type>("id\tvalue").empty());
+}
+
+TEST_CASE("parallel_load - binds fields to header columns by name")
+{
+    tsv::options opts;
+    opts.column_names = {"id", "value"};
+
+    auto const records = tsv::parallel_load<record_type>(
+        "value\tid\n0.5\t1\n1.5\t2\n", opts, 2
+    );
+
+    CHECK(records.size() == 2);
+    CHECK(records.at(0).id == 1);
+    CHECK(records.at(0).value == doctest::Approx(0.5));
+    CHECK(records.at(1).id == 2);
+    CHECK(records.at(1).value == doctest::Approx(1.5));
+}
+
+TEST_CASE("parallel_load - collects bad rows in input order")
+{
+    auto text = make_input(50000);
+
+    for (auto const id : {"\n100\t", "\n25000\t", "\n40000\t"}) {
+        auto const pos = text.find(id) + 1;
+        text.replace(pos, 2, "xx");
+    }
+
+    std::vector<tsv::error> errors;
+    tsv::options opts;
+    opts.comment = '#';
+    opts.on_error = tsv::error_policy::collect;
+    opts.rejected = &errors;
+
+    auto const records = tsv::parallel_load<record_type>(text, opts, 4);
+
+    CHECK(records.size() == 50000 - 3);
+    REQUIRE(errors.size() == 3);
+    CHECK(errors[0].line_number == 1 + 1 + 101);
+    CHECK(errors[1].line_number == 1 + 25 + 25001);
+    CHECK(errors[2].line_number == 1 + 40 + 40001);
+    CHECK(errors[2].line == "xx000\t0.5");
+}
+
+TEST_CASE("parallel_load - merges load statistics of chunks")
+{
+    auto const text = make_input(50000);
+
+    tsv::load_stats stats;
+    std::vector<std::uint64_t> progress;
+
+    tsv::options opts;
+    opts.comment = '#';
+    opts.stats = &stats;
+    opts.progress = [&](tsv::load_stats const& current) {
+        progress.push_back(current.rows);
+    };
+
+    auto const records = tsv::parallel_load<record_type>(text, opts, 4);
+
+    CHECK(records.size() == 50000);
+    CHECK(stats.bytes == text.size());
+    CHECK(stats.lines == 1 + 50 + 50000);
+    CHECK(stats.skipped_lines == 50);
+    CHECK(stats.rows == 50000);
+    REQUIRE(progress.size() > 1);
+    CHECK(std::is_sorted(progress.begin(), progress.end()));
+    CHECK(progress.back() == 50000);
+}
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -264,3 +265,184 @@ TEST_CASE("parser::parse_record")
     }
 
 }
+
+TEST_CASE("field_splitter - splits text into fields")
+{
+    using tsv::detail::field_splitter;
+
+    SUBCASE("short examples")
+    {
+        struct example
+        {
+            std::string_view text;
+            std::vector<std::string_view> expected;
+        };
+
+        std::vector<example> const examples = {
+            {"", {""}},
+            {"abc", {"abc"}},
+            {"a|b", {"a", "b"}},
+            {"a|b|", {"a", "b", ""}},
+            {"||", {"", "", ""}},
+        };
+
+        for (auto&& [text, expected] : examples) {
+            INFO("text = \"", text, "\"");
+
+            field_splitter splitter{text, '|'};
+            std::vector<std::string_view> actual;
+            while (!splitter.done()) {
+                actual.push_back(splitter.next());
+            }
+            CHECK(actual == expected);
+        }
+    }
+
+    SUBCASE("fields crossing scan blocks")
+    {
+        for (std::size_t width = 0; width < 70; width++) {
+            std::string text;
+            std::vector<std::string> expected;
+
+            for (std::size_t i = 0; i < 10; i++) {
+                expected.push_back(std::string(width, char('a' + i)));
+                text += expected.back();
+                if (i < 9) {
+                    text += '\t';
+                }
+            }
+
+            INFO("width = ", width);
+
+            field_splitter splitter{text, '\t'};
+            std::vector<std::string> actual;
+            while (!splitter.done()) {
+                actual.push_back(std::string{splitter.next()});
+            }
+            CHECK(actual == expected);
+        }
+    }
+}
+
+TEST_CASE("parser::parse_record - with projection")
+{
+    struct record_type
+    {
+        std::string label;
+        int value;
+    };
+
+    tsv::detail::projection const projection{{3, 1}, 2};
+
+    SUBCASE("valid input")
+    {
+        std::istringstream source{
+            "x\t1\ty\tfoo\tignored\n"
+            "x\t2\ty\tbar\n"
+        };
+        tsv::detail::parser parser{source, '\t'};
+
+        record_type record;
+        CHECK(parser.parse_record(record, projection));
+        CHECK(record.label == "foo");
+        CHECK(record.value == 1);
+
+        CHECK(parser.parse_record(record, projection));
+        CHECK(record.label == "bar");
+        CHECK(record.value == 2);
+
+        CHECK_FALSE(parser.parse_record(record, projection));
+    }
+
+    SUBCASE("missing column")
+    {
+        std::istringstream source{"x\t1\ty\n"};
+        tsv::detail::parser parser{source, '\t'};
+
+        record_type record;
+        CHECK_THROWS_AS(parser.parse_record(record, projection), tsv::format_error);
+    }
+
+    SUBCASE("unselected columns are not parsed")
+    {
+        std::istringstream source{"not a number\t1\t\tfoo\n"};
+        tsv::detail::parser parser{source, '\t'};
+
+        record_type record;
+        CHECK(parser.parse_record(record, projection));
+        CHECK(record.value == 1);
+    }
+}
+
+TEST_CASE("parse_record - parses numeric fields in place")
+{
+    struct record_type
+    {
+        int a1, a2, a3, a4, a5, a6, a7, a8, a9, a10;
+        double b1, b2, b3, b4, b5;
+        std::string label;
+        unsigned c1, c2, c3, c4;
+    };
+
+    tsv::detail::field_type_list<record_type> field_types;
+
+    SUBCASE("valid rows crossing scan blocks")
+    {
+        std::string const text =
+            "1\t-2\t3\t-4\t5\t-6\t7\t-8\t9\t-10\t"
+            "0.5\t-1.5\t2.25\t1e3\t12345.678\t"
+            "some label text\t"
+            "100\t200\t300\t400";
+
+        for (char delim : {'\t', ',', '|'}) {
+            std::string line = text;
+            std::replace(line.begin(), line.end(), '\t', delim);
+
+            auto const record = tsv::detail::parse_record<record_type>(
+                line, delim, field_types
+            );
+
+            CHECK(record.a1 == 1);
+            CHECK(record.a10 == -10);
+            CHECK(record.b2 == -1.5);
+            CHECK(record.b4 == 1000);
+            CHECK(record.b5 == doctest::Approx(12345.678));
+            CHECK(record.label == "some label text");
+            CHECK(record.c1 == 100);
+            CHECK(record.c4 == 400);
+        }
+    }
+
+    SUBCASE("errors")
+    {
+        std::string const prefix = "1\t2\t3\t4\t5\t6\t7\t8\t9\t10\t1\t2\t3\t4\t5\tx\t";
+
+        struct example
+        {
+            std::string suffix;
+            char const* message;
+        };
+
+        std::vector<example> const examples = {
+            {"1\t2\t3", tsv::format_error::missing_field},
+            {"1\t2\t3\t4\t", tsv::format_error::excess_field},
+            {"1\t2\t3\t4\t5", tsv::format_error::excess_field},
+            {"1\t2x\t3\t4", tsv::parse_error::leftover},
+            {"1\t\t3\t4", tsv::parse_error::unknown},
+            {"1\t-2\t3\t4", tsv::parse_error::unknown},
+            {"1\t99999999999\t3\t4", tsv::parse_error::out_of_range},
+        };
+
+        for (auto&& [suffix, message] : examples) {
+            auto const line = prefix + suffix;
+            INFO("line = \"", line, "\"");
+
+            try {
+                tsv::detail::parse_record<record_type>(line, '\t', field_types);
+                FAIL("exception is not thrown");
+            } catch (tsv::error const& err) {
+                CHECK(std::string{err.what()} == message);
+            }
+        }
+    }
+}
@@ -0,0 +1,408 @@
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <doctest.h>
+#include <tsv.hpp>
+
+
+TEST_CASE("reader - iterates over records")
+{
+    struct record_type
+    {
+        int id;
+        std::string name;
+    };
+
+    std::istringstream input{
+        "id\tname\n"
+        "# comment\n"
+        "1\tfoo\n"
+        "\n"
+        "2\tbar\n"
+    };
+
+    tsv::options opts;
+    opts.comment = '#';
+
+    tsv::reader<record_type> reader{input, opts};
+
+    CHECK(reader.header() == std::vector<std::string>{"id", "name"});
+
+    std::vector<int> ids;
+    std::vector<std::string> names;
+
+    for (auto& record : reader) {
+        ids.push_back(record.id);
+        names.push_back(std::move(record.name));
+    }
+
+    CHECK(ids == std::vector<int>{1, 2});
+    CHECK(names == std::vector<std::string>{"foo", "bar"});
+}
+
+TEST_CASE("reader - reads records one by one")
+{
+    struct record_type
+    {
+        int value;
+    };
+
+    std::istringstream input{"10\n20\n"};
+    tsv::options opts;
+    opts.header = false;
+
+    tsv::reader<record_type> reader{input, opts};
+
+    record_type record;
+
+    CHECK(reader.read(record));
+    CHECK(record.value == 10);
+
+    CHECK(reader.read(record));
+    CHECK(record.value == 20);
+
+    CHECK_FALSE(reader.read(record));
+}
+
+TEST_CASE("reader - reports errors")
+{
+    struct record_type
+    {
+        int value;
+
+        void validate() const
+        {
+            tsv::check(value > 0, "value must be positive");
+        }
+    };
+
+    SUBCASE("missing header")
+    {
+        std::istringstream input{""};
+        CHECK_THROWS_AS(tsv::reader<record_type>{input}, tsv::format_error);
+    }
+
+    SUBCASE("validation error")
+    {
+        std::istringstream input{"value\n1\n-1\n"};
+        tsv::reader<record_type> reader{input};
+
+        auto it = reader.begin();
+        CHECK(it->value == 1);
+        CHECK_THROWS_AS(++it, tsv::validation_error);
+    }
+}
+
+TEST_CASE("reader - skips or collects bad rows")
+{
+    struct record_type
+    {
+        int value;
+        std::string name;
+
+        void validate() const
+        {
+            tsv::check(value > 0, "value must be positive");
+        }
+    };
+
+    std::string const text =
+        "value\tname\n"
+        "1\tfoo\n"
+        "x\tbar\n"
+        "2\n"
+        "-3\tbaz\n"
+        "4\tqux\textra\n"
+        "5\tquux\n";
+
+    SUBCASE("raise")
+    {
+        std::istringstream input{text};
+        tsv::reader<record_type> reader{input};
+
+        record_type record;
+        CHECK(reader.read(record));
+        CHECK_THROWS_AS(reader.read(record), tsv::parse_error);
+    }
+
+    SUBCASE("skip")
+    {
+        std::istringstream input{text};
+        tsv::options opts;
+        opts.on_error = tsv::error_policy::skip;
+
+        tsv::reader<record_type> reader{input, opts};
+
+        std::vector<int> values;
+        for (auto& record : reader) {
+            values.push_back(record.value);
+        }
+
+        CHECK(values == std::vector<int>{1, 5});
+        CHECK(reader.rejected() == 4);
+    }
+
+    SUBCASE("collect")
+    {
+        std::istringstream input{text};
+        std::vector<tsv::error> errors;
+        tsv::options opts;
+        opts.on_error = tsv::error_policy::collect;
+        opts.rejected = &errors;
+
+        auto const records = tsv::load<record_type>(input, opts);
+
+        CHECK(records.size() == 2);
+        REQUIRE(errors.size() == 4);
+
+        CHECK(errors[0].what() == std::string{tsv::parse_error::unknown});
+        CHECK(errors[0].line == "x\tbar");
+        CHECK(errors[0].line_number == 3);
+
+        CHECK(errors[1].what() == std::string{tsv::format_error::missing_field});
+        CHECK(errors[1].line_number == 4);
+
+        CHECK(errors[2].what() == std::string{"value must be positive"});
+        CHECK(errors[2].line == "-3\tbaz");
+        CHECK(errors[2].line_number == 5);
+
+        CHECK(errors[3].what() == std::string{tsv::format_error::excess_field});
+        CHECK(errors[3].line_number == 6);
+    }
+
+    SUBCASE("collect without vector")
+    {
+        std::istringstream input{text};
+        tsv::options opts;
+        opts.on_error = tsv::error_policy::collect;
+
+        CHECK_THROWS_AS(tsv::reader<record_type>(input, opts), std::invalid_argument);
+    }
+}
+
+namespace
+{
+    struct batch_record
+    {
+        int value;
+
+        static inline std::vector<std::size_t> block_sizes;
+
+        // Returns the number of leading records with positive values.
+        static std::size_t validate_batch(tsv::span<batch_record const> records)
+        {
+            block_sizes.push_back(records.size());
+
+            std::size_t valid = 0;
+            while (valid < records.size() && records[valid].value > 0) {
+                valid++;
+            }
+            return valid;
+        }
+    };
+}
+
+TEST_CASE("reader - validates records in blocks")
+{
+    std::string text = "value\n";
+    for (int i = 1; i <= 3000; i++) {
+        text += std::to_string(i % 1000 == 500 ? -i : i);
+        text += '\n';
+    }
+
+    SUBCASE("raise")
+    {
+        batch_record::block_sizes.clear();
+
+        try {
+            tsv::load<batch_record>(std::istringstream{text});
+            FAIL("no exception");
+        } catch (tsv::validation_error const& err) {
+            CHECK(err.line_number == 501);
+        }
+        CHECK(batch_record::block_sizes == std::vector<std::size_t>{1024});
+    }
+
+    SUBCASE("collect")
+    {
+        batch_record::block_sizes.clear();
+
+        std::vector<tsv::error> errors;
+        tsv::load_stats stats;
+        tsv::options opts;
+        opts.on_error = tsv::error_policy::collect;
+        opts.rejected = &errors;
+        opts.stats = &stats;
+
+        auto const records = tsv::load<batch_record>(std::istringstream{text}, opts);
+
+        CHECK(records.size() == 2997);
+        CHECK(records.at(499).value == 501);
+        CHECK(stats.rows == 2997);
+        CHECK(stats.rejected_rows == 3);
+
+        REQUIRE(errors.size() == 3);
+        CHECK(errors[0].line_number == 501);
+        CHECK(errors[1].line_number == 1501);
+        CHECK(errors[2].line_number == 2501);
+
+        // Each block is validated again after the invalid record.
+        CHECK(batch_record::block_sizes.size() == 6);
+    }
+
+    SUBCASE("errors in the input order")
+    {
+        std::string const input = "value\n-1\n2\nbad\n3\n";
+
+        std::vector<tsv::error> errors;
+        tsv::options opts;
+        opts.on_error = tsv::error_policy::collect;
+        opts.rejected = &errors;
+
+        auto const records = tsv::load<batch_record>(std::istringstream{input}, opts);
+
+        REQUIRE(records.size() == 2);
+        CHECK(records[0].value == 2);
+        CHECK(records[1].value == 3);
+
+        REQUIRE(errors.size() == 2);
+        CHECK(errors[0].line_number == 2);
+        CHECK(errors[0].line == "-1");
+        CHECK(errors[1].line_number == 4);
+        CHECK(errors[1].line == "bad");
+
+        try {
+            tsv::load<batch_record>(std::istringstream{input});
+            FAIL("no exception");
+        } catch (tsv::validation_error const& err) {
+            CHECK(err.line_number == 2);
+            CHECK(err.line == "-1");
+        }
+    }
+
+    SUBCASE("reader")
+    {
+        std::istringstream input{text};
+        tsv::reader<batch_record> reader{input};
+
+        batch_record record;
+        for (int i = 1; i < 500; i++) {
+            REQUIRE(reader.read(record));
+        }
+        CHECK_THROWS_AS(reader.read(record), tsv::validation_error);
+    }
+}
+
+TEST_CASE("reader - reads stream ahead if requested")
+{
+    struct record_type
+    {
+        int id;
+        std::string name;
+    };
+
+    std::istringstream input{
+        "id\tname\n"
+        "1\tfoo\n"
+        "2\tbar\n"
+    };
+
+    tsv::options opts;
+    opts.read_ahead = true;
+
+    auto const records = tsv::load<record_type>(input, opts);
+
+    REQUIRE(records.size() == 2);
+    CHECK(records.at(1).id == 2);
+    CHECK(records.at(1).name == "bar");
+}
+
+TEST_CASE("reader - counts load statistics")
+{
+    struct record_type
+    {
+        int id;
+        std::string name;
+    };
+
+    std::string const text =
+        "id\tname\n"
+        "# comment\n"
+        "1\tfoo\n"
+        "\n"
+        "x\tbar\n"
+        "3\tbaz\n";
+
+    tsv::load_stats stats;
+    std::vector<std::uint64_t> progress;
+
+    tsv::options opts;
+    opts.comment = '#';
+    opts.on_error = tsv::error_policy::skip;
+    opts.stats = &stats;
+    opts.progress = [&](tsv::load_stats const& current) {
+        progress.push_back(current.rows);
+    };
+    opts.progress_interval = 1;
+
+    auto const records = tsv::load<record_type>(std::istringstream{text}, opts);
+
+    CHECK(records.size() == 2);
+    CHECK(stats.bytes == text.size());
+    CHECK(stats.lines == 6);
+    CHECK(stats.skipped_lines == 2);
+    CHECK(stats.rows == 2);
+    CHECK(stats.rejected_rows == 1);
+    CHECK(progress == std::vector<std::uint64_t>{1, 2, 2});
+
+#if !TSV_ENABLE_TIMING
+    CHECK(stats.read_time.count() == 0);
+    CHECK(stats.parse_time.count() == 0);
+#endif
+
+    // Counters accumulate over loads.
+    opts.progress = nullptr;
+    tsv::load<record_type>(std::istringstream{text}, opts);
+    CHECK(stats.rows == 4);
+
+    // Progress is reported into the stats.
+    opts.stats = nullptr;
+    opts.progress = [](tsv::load_stats const&) {};
+    CHECK_THROWS_AS(
+        tsv::load<record_type>(std::istringstream{text}, opts),
+        std::invalid_argument
+    );
+}
+
+TEST_CASE("load_into - counts skipped header lines")
+{
+    struct record_type
+    {
+        int value;
+    };
+
+    std::string const text = "# c\na\n1\n2\n";
+
+    tsv::options opts;
+    opts.comment = '#';
+
+    tsv::load_stats expected;
+    opts.stats = &expected;
+    tsv::load<record_type>(std::istringstream{text}, opts);
+
+    tsv::load_stats stats;
+    opts.stats = &stats;
+    std::vector<record_type> records;
+    tsv::load_into(records, std::istringstream{text}, opts);
+
+    CHECK(records.size() == 2);
+    CHECK(stats.bytes == expected.bytes);
+    CHECK(stats.lines == expected.lines);
+    CHECK(stats.skipped_lines == expected.skipped_lines);
+    CHECK(stats.rows == expected.rows);
+    CHECK(stats.lines == 4);
+    CHECK(stats.bytes == text.size());
+    CHECK(stats.skipped_lines == 1);
+}
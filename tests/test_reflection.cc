@@ -1,10 +1,41 @@
+#include <sstream>
 #include <string>
 #include <type_traits>
+#include <vector>
 
 #include <doctest.h>
 #include <tsv.hpp>
 
 
+namespace
+{
+    struct wide_record
+    {
+        int a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14, a15, a16, a17, a18, a19, a20, a21, a22, a23, a24, a25, a26, a27, a28, a29, a30, a31, a32, a33, a34, a35, a36, a37, a38, a39, a40, a41, a42, a43, a44, a45;
+    };
+
+    struct listed_record
+    {
+        int id;
+        std::string name;
+        double value;
+    };
+
+    struct compiled_record
+    {
+        int id;
+        std::string name;
+    };
+}
+
+template<>
+struct tsv::fields<listed_record>
+    : tsv::members<&listed_record::id, &listed_record::name, &listed_record::value>
+{
+};
+
+TSV_EXTERN_RECORD(compiled_record);
+
 TEST_CASE("record_size_v - detects number of aggregate fields")
 {
     using tsv::detail::record_size_v;
@@ -18,6 +49,7 @@ TEST_CASE("record_size_v - detects number of aggregate fields")
     static_assert(record_size_v<record_1> == 1);
     static_assert(record_size_v<record_2> == 2);
     static_assert(record_size_v<record_3> == 3);
+    static_assert(record_size_v<wide_record> == 45);
 }
 
 TEST_CASE("field_type_list - detects aggregate field types")
@@ -62,3 +94,54 @@ TEST_CASE("field_type_list - detects aggregate field types")
         static_assert(std::is_same_v<actual, expected>);
     }
 }
+
+TEST_CASE("fields - lists fields explicitly")
+{
+    using tsv::detail::type_list;
+    using tsv::detail::field_type_list;
+
+    static_assert(tsv::detail::record_size_v<listed_record> == 3);
+    static_assert(std::is_same_v<
+        field_type_list<listed_record>, type_list<int, std::string, double>
+    >);
+
+    auto const records = tsv::load<listed_record>(
+        std::istringstream{"id\tname\tvalue\n1\tfoo\t0.5\n"}
+    );
+
+    REQUIRE(records.size() == 1);
+    CHECK(records[0].id == 1);
+    CHECK(records[0].name == "foo");
+    CHECK(records[0].value == 0.5);
+
+    std::ostringstream output;
+    tsv::dump(output, records);
+    CHECK(output.str() == "1\tfoo\t0.5\n");
+}
+
+TEST_CASE("load - loads wide records")
+{
+    std::string line;
+    for (int i = 1; i <= 45; i++) {
+        line += (i > 1 ? "\t" : "") + std::to_string(i);
+    }
+
+    tsv::options opts;
+    opts.header = false;
+
+    auto const records = tsv::load<wide_record>(std::istringstream{line + "\n"}, opts);
+
+    REQUIRE(records.size() == 1);
+    CHECK(records[0].a1 == 1);
+    CHECK(records[0].a45 == 45);
+}
+
+TEST_CASE("TSV_INSTANTIATE_RECORD - compiles readers of a record type")
+{
+    auto const records = tsv::load<compiled_record>(std::istringstream{"id\tname\n1\tfoo\n"});
+
+    REQUIRE(records.size() == 1);
+    CHECK(records[0].name == "foo");
+}
+
+TSV_INSTANTIATE_RECORD(compiled_record);
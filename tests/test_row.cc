@@ -0,0 +1,123 @@
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <doctest.h>
+#include <tsv.hpp>
+
+
+TEST_CASE("row - locates and converts fields on demand")
+{
+    tsv::row const row{"12\tfoo\t3.5", '\t'};
+
+    CHECK(row.line() == "12\tfoo\t3.5");
+    CHECK(row.get<int>(0) == 12);
+    CHECK(row.field(1) == "foo");
+    CHECK(row.get<double>(2) == 3.5);
+    CHECK(row.size() == 3);
+
+    CHECK_THROWS_AS(row.field(3), tsv::format_error);
+    CHECK_THROWS_AS(row.get<int>(1), tsv::parse_error);
+
+    struct record_type
+    {
+        int id;
+        std::string name;
+        double value;
+    };
+
+    auto const record = row.parse<record_type>();
+    CHECK(record.id == 12);
+    CHECK(record.name == "foo");
+    CHECK(record.value == 3.5);
+
+    CHECK(tsv::row{""}.size() == 1);
+    CHECK(tsv::row{}.size() == 0);
+}
+
+TEST_CASE("row_reader - filters rows before parsing records")
+{
+    struct record_type
+    {
+        std::string name;
+        int count;
+
+        void validate() const
+        {
+            tsv::check(count >= 0, "count must not be negative");
+        }
+    };
+
+    std::istringstream input{
+        "key\tcount\tname\n"
+        "# comment\n"
+        "a\t1\tfoo\n"
+        "b\tx\tbar\n"
+        "\n"
+        "a\t3\tbaz\n"
+        "a\t-1\tqux\n"
+    };
+
+    tsv::load_stats stats;
+    tsv::options opts;
+    opts.comment = '#';
+    opts.column_names = {"name", "count"};
+    opts.stats = &stats;
+
+    tsv::row_reader reader{input, opts};
+
+    CHECK(reader.header() == std::vector<std::string>{"key", "count", "name"});
+    CHECK(reader.column("key") == 0);
+    CHECK_THROWS_AS(reader.column("none"), tsv::format_error);
+
+    std::vector<record_type> records;
+    std::vector<std::size_t> lines;
+
+    while (auto const row = reader.read()) {
+        if (row->field(reader.column("key")) != "a") {
+            continue;
+        }
+        lines.push_back(row->line_number());
+
+        try {
+            records.push_back(row->parse<record_type>());
+        } catch (tsv::validation_error const& err) {
+            CHECK(err.line_number == 7);
+            CHECK(err.line == "a\t-1\tqux");
+        }
+    }
+
+    CHECK(lines == std::vector<std::size_t>{3, 6, 7});
+    REQUIRE(records.size() == 2);
+    CHECK(records[0].name == "foo");
+    CHECK(records[1].count == 3);
+
+    CHECK(stats.rows == 4);
+    CHECK(stats.skipped_lines == 2);
+}
+
+TEST_CASE("row_reader - reports error line")
+{
+    std::istringstream input{"1\tfoo\n2.5\tbar\n"};
+
+    tsv::options opts;
+    opts.header = false;
+
+    tsv::row_reader reader{input, opts};
+
+    REQUIRE(reader.read());
+    auto const row = reader.read();
+    REQUIRE(row);
+
+    try {
+        row->get<int>(0);
+        FAIL("no exception");
+    } catch (tsv::parse_error const& err) {
+        CHECK(err.line_number == 2);
+        CHECK(err.line == "2.5\tbar");
+    }
+
+    CHECK(row->get<std::string>(1) == "bar");
+    CHECK_FALSE(reader.read());
+}
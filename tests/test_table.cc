@@ -0,0 +1,101 @@
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <doctest.h>
+#include <tsv.hpp>
+
+
+TEST_CASE("load_table - loads columns of runtime types")
+{
+    std::vector<tsv::column_spec> const schema = {
+        {"name", tsv::column_type::string},
+        {"id", tsv::column_type::int64},
+        {"value", tsv::column_type::float64},
+        {"kind", tsv::column_type::interned},
+    };
+
+    std::istringstream input{
+        "id\tkind\tvalue\tname\tunused\n"
+        "1\tred\t0.5\tfoo\tx\n"
+        "-9000000000\tblue\t1e10\t\tx\n"
+        "3\tred\t-2\tbar baz\tx\n"
+    };
+
+    tsv::dictionary dictionary;
+    tsv::options opts;
+    opts.dictionary = &dictionary;
+
+    auto const table = tsv::load_table(input, schema, opts);
+
+    REQUIRE(table.size() == 3);
+    REQUIRE(table.column_count() == 4);
+    CHECK(table.column("value") == 2);
+
+    auto const ids = table.int64s(1);
+    REQUIRE(ids.size() == 3);
+    CHECK(ids[0] == 1);
+    CHECK(ids[1] == -9000000000);
+
+    auto const values = table.float64s(2);
+    CHECK(values[1] == 1e10);
+    CHECK(values[2] == -2);
+
+    CHECK(table.string(0, 0) == "foo");
+    CHECK(table.string(0, 1) == "");
+    CHECK(table.string(0, 2) == "bar baz");
+
+    auto const kinds = table.codes(3);
+    CHECK(kinds[0] == kinds[2]);
+    CHECK(kinds[0] != kinds[1]);
+    CHECK(table.string(3, 1) == "blue");
+
+    CHECK_THROWS_AS(table.int64s(0), std::invalid_argument);
+    CHECK_THROWS_AS(table.column("unused"), std::invalid_argument);
+}
+
+TEST_CASE("load_table - handles bad rows")
+{
+    std::vector<tsv::column_spec> const schema = {
+        {"a", tsv::column_type::string},
+        {"b", tsv::column_type::int64},
+    };
+
+    std::string const text = "x\t1\ny\tz\nw\t2\n";
+
+    tsv::options opts;
+    opts.header = false;
+
+    SUBCASE("raise") {
+        try {
+            tsv::load_table(std::istringstream{text}, schema, opts);
+            FAIL("error is not thrown");
+        } catch (tsv::parse_error const& err) {
+            CHECK(err.line_number == 2);
+        }
+    }
+
+    SUBCASE("collect") {
+        std::vector<tsv::error> rejected;
+        opts.on_error = tsv::error_policy::collect;
+        opts.rejected = &rejected;
+
+        auto const table = tsv::load_table(std::istringstream{text}, schema, opts);
+
+        // The string of the bad row is not left in the buffer.
+        REQUIRE(table.size() == 2);
+        CHECK(table.string(0, 1) == "w");
+        CHECK(table.int64s(1)[1] == 2);
+        REQUIRE(rejected.size() == 1);
+        CHECK(rejected[0].line_number == 2);
+    }
+
+    SUBCASE("missing column") {
+        opts.header = true;
+        CHECK_THROWS_AS(
+            tsv::load_table(std::istringstream{"a\tc\n"}, schema, opts),
+            tsv::format_error
+        );
+    }
+}
@@ -35,3 +35,324 @@ TEST_CASE("load - accepts rvalue stream")
     struct record { int id; };
     tsv::load<record>(std::istringstream{"id"});
 }
+
+TEST_CASE("load_into - reuses vector capacity")
+{
+    struct record_type
+    {
+        int id;
+        double value;
+    };
+
+    std::string const text =
+        "# comment\n"
+        "id\tvalue\n"
+        "1\t0.5\n"
+        "2\t1.5\n";
+
+    tsv::options opts;
+    opts.comment = '#';
+
+    std::vector<record_type> records(10);
+    auto const data = records.data();
+
+    tsv::load_into(records, std::istringstream{text}, opts);
+
+    CHECK(records.size() == 2);
+    CHECK(records.data() == data);
+    CHECK(records.at(0).id == 1);
+    CHECK(records.at(1).value == 1.5);
+
+    tsv::load_into(records, std::istringstream{text}, opts);
+
+    CHECK(records.size() == 2);
+    CHECK(records.data() == data);
+
+    CHECK_THROWS_AS(
+        tsv::load_into(records, std::istringstream{"# comment\n"}, opts),
+        tsv::format_error
+    );
+}
+
+TEST_CASE("load - selects columns")
+{
+    struct record_type
+    {
+        double value;
+        unsigned row;
+    };
+
+    std::istringstream input{
+        "row\tcolumn\tvalue\tnote\n"
+        "1\t2\t1.23\tfoo\n"
+        "3\t4\t4.56\n"
+    };
+
+    tsv::options opts;
+    opts.columns = {2, 0};
+
+    auto const records = tsv::load<record_type>(input, opts);
+
+    CHECK(records.size() == 2);
+    CHECK(records.at(0).value == doctest::Approx(1.23));
+    CHECK(records.at(0).row == 1);
+    CHECK(records.at(1).value == doctest::Approx(4.56));
+    CHECK(records.at(1).row == 3);
+}
+
+TEST_CASE("load - rejects invalid column selection")
+{
+    struct record_type
+    {
+        int a;
+        int b;
+    };
+
+    tsv::options opts;
+
+    opts.columns = {0};
+    CHECK_THROWS_AS(
+        tsv::load<record_type>(std::istringstream{"a\tb"}, opts),
+        std::invalid_argument
+    );
+
+    opts.columns = {1, 1};
+    CHECK_THROWS_AS(
+        tsv::load<record_type>(std::istringstream{"a\tb"}, opts),
+        std::invalid_argument
+    );
+}
+
+TEST_CASE("load - binds fields to header columns by name")
+{
+    struct record_type
+    {
+        unsigned row;
+        double value;
+    };
+
+    tsv::options opts;
+    opts.column_names = {"row", "value"};
+
+    SUBCASE("columns in any order")
+    {
+        std::istringstream input{
+            "value\tnote\trow\n"
+            "1.23\tfoo\t1\n"
+            "4.56\tbar\t3\n"
+        };
+
+        auto const records = tsv::load<record_type>(input, opts);
+
+        CHECK(records.size() == 2);
+        CHECK(records.at(0).row == 1);
+        CHECK(records.at(0).value == doctest::Approx(1.23));
+        CHECK(records.at(1).row == 3);
+        CHECK(records.at(1).value == doctest::Approx(4.56));
+    }
+
+    SUBCASE("missing column")
+    {
+        std::istringstream input{
+            "value\tnote\n"
+            "1.23\tfoo\n"
+        };
+        CHECK_THROWS_AS(tsv::load<record_type>(input, opts), tsv::format_error);
+    }
+
+    SUBCASE("header is required")
+    {
+        opts.header = false;
+        CHECK_THROWS_AS(
+            tsv::load<record_type>(std::istringstream{"1\t2"}, opts),
+            std::invalid_argument
+        );
+    }
+}
+
+TEST_CASE("load - filters rows on raw field text")
+{
+    struct record_type
+    {
+        int id;
+        double value;
+    };
+
+    // Rows dropped by the filters are not parsed, so bad values in them are
+    // not reported.
+    std::string const text =
+        "id\tvalue\tcountry\tcode\n"
+        "1\t0.5\tUS\tA-1\n"
+        "2\tbad\tJP\tA-2\n"
+        "# comment\n"
+        "3\t1.5\tUS\tB-3\n"
+        "4\t2.5\tUS\tA-4\n"
+        "5\t3.5\n";
+
+    tsv::load_stats stats;
+    tsv::options opts;
+    opts.comment = '#';
+    opts.columns = {0, 1};
+    opts.stats = &stats;
+
+    SUBCASE("equals")
+    {
+        opts.filters = {tsv::equals(2, "US")};
+        opts.on_error = tsv::error_policy::skip;
+
+        auto const records = tsv::load<record_type>(std::istringstream{text}, opts);
+
+        REQUIRE(records.size() == 4);
+        CHECK(records.at(0).id == 1);
+        CHECK(records.at(1).id == 3);
+        CHECK(records.at(2).id == 4);
+        CHECK(records.at(3).id == 5);
+        CHECK(stats.filtered_rows == 1);
+        CHECK(stats.rejected_rows == 0);
+    }
+
+    SUBCASE("multiple filters")
+    {
+        opts.filters = {tsv::starts_with(3, "A-"), tsv::one_of(2, {"US", "UK"})};
+
+        // The last row is too short to test and is accepted.
+        auto const records = tsv::load<record_type>(std::istringstream{text}, opts);
+
+        REQUIRE(records.size() == 3);
+        CHECK(records.at(0).id == 1);
+        CHECK(records.at(1).id == 4);
+        CHECK(records.at(2).id == 5);
+        CHECK(stats.filtered_rows == 2);
+    }
+
+    SUBCASE("custom predicate")
+    {
+        opts.filters = {{0, [](std::string_view id) { return id == "2"; }}};
+        CHECK_THROWS_AS(
+            tsv::load<record_type>(std::istringstream{text}, opts),
+            tsv::parse_error
+        );
+    }
+
+    SUBCASE("parallel")
+    {
+        opts.filters = {tsv::equals(2, "US")};
+
+        auto const records = tsv::parallel_load<record_type>(text, opts, 2);
+        CHECK(records.size() == 4);
+        CHECK(stats.filtered_rows == 1);
+    }
+}
+
+TEST_CASE("load - filters rows with escaped delimiters")
+{
+    struct record_type
+    {
+        std::string name;
+        std::string country;
+        std::string code;
+    };
+
+    std::string const text =
+        "name\tcountry\tcode\n"
+        "x\\\ty\tUS\tz\n"
+        "a\\\\\tJP\tb\n"
+        "c\tU\\S\td\n";
+
+    tsv::options opts;
+    opts.escaping = tsv::escaping::backslash;
+    opts.columns = {0, 1, 2};
+    opts.filters = {tsv::equals(1, "US")};
+
+    auto const records = tsv::load<record_type>(std::istringstream{text}, opts);
+
+    REQUIRE(records.size() == 2);
+    CHECK(records.at(0).name == "x\ty");
+    CHECK(records.at(0).country == "US");
+    CHECK(records.at(0).code == "z");
+    CHECK(records.at(1).name == "c");
+}
+
+TEST_CASE("load_columns - loads fields into columns")
+{
+    struct record_type
+    {
+        unsigned row;
+        std::string label;
+        double value;
+    };
+
+    std::istringstream input{
+        "row\tlabel\tvalue\n"
+        "1\tfoo\t1.23\n"
+        "3\tbar\t4.56\n"
+    };
+
+    auto const [rows, labels, values] = tsv::load_columns<record_type>(input);
+
+    CHECK(rows == std::vector<unsigned>{1, 3});
+    CHECK(labels == std::vector<std::string>{"foo", "bar"});
+    CHECK(values.size() == 2);
+    CHECK(values.at(0) == doctest::Approx(1.23));
+    CHECK(values.at(1) == doctest::Approx(4.56));
+}
+
+TEST_CASE("load_columns - validates records")
+{
+    struct record_type
+    {
+        int value;
+
+        void validate() const
+        {
+            tsv::check(value > 0, "value must be positive");
+        }
+    };
+
+    CHECK_THROWS_AS(
+        tsv::load_columns<record_type>(std::istringstream{"value\n1\n0\n"}),
+        tsv::validation_error
+    );
+}
+
+TEST_CASE("load - unescapes backslash sequences")
+{
+    struct record_type
+    {
+        std::string name;
+        int value;
+        std::string note;
+    };
+
+    std::istringstream input{
+        "value\tname\tnote\n"
+        "1\tplain\tclean\n"
+        "2\ttab\\there\ta\\\\b\\\td\n"
+        "3\tline\\nbreak\t\\q\\\\\n"
+    };
+
+    tsv::options opts;
+    opts.column_names = {"name", "value", "note"};
+    opts.escaping = tsv::escaping::backslash;
+
+    auto const records = tsv::load<record_type>(input, opts);
+
+    REQUIRE(records.size() == 3);
+    CHECK(records[0].name == "plain");
+    CHECK(records[0].note == "clean");
+    CHECK(records[1].name == "tab\there");
+    CHECK(records[1].value == 2);
+    CHECK(records[1].note == "a\\b\td");
+    CHECK(records[2].name == "line\nbreak");
+    CHECK(records[2].note == "q\\");
+
+    struct view_record
+    {
+        std::string_view name;
+    };
+
+    CHECK_THROWS_AS(
+        tsv::load_document<view_record>(std::istringstream{"name\na\n"}, opts),
+        std::invalid_argument
+    );
+}
@@ -0,0 +1,249 @@
+#include <cstdint>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <doctest.h>
+#include <tsv.hpp>
+
+
+namespace
+{
+    struct point
+    {
+        int x;
+        int y;
+    };
+}
+
+template<>
+struct tsv::conversion<point>
+{
+    static point parse(std::string_view text)
+    {
+        auto const comma = text.find(',');
+        return {
+            tsv::conversion<int>::parse(text.substr(0, comma)),
+            tsv::conversion<int>::parse(text.substr(comma + 1))
+        };
+    }
+
+    static void format(point const& value, std::string& out)
+    {
+        tsv::conversion<int>::format(value.x, out);
+        out += ',';
+        tsv::conversion<int>::format(value.y, out);
+    }
+};
+
+TEST_CASE("conversion - formats values")
+{
+    auto const format = [](auto const& value) {
+        std::string out = ">";
+        tsv::conversion<std::decay_t<decltype(value)>>::format(value, out);
+        return out;
+    };
+
+    CHECK(format(-123) == ">-123");
+    CHECK(format(std::numeric_limits<std::uint64_t>::max()) == ">18446744073709551615");
+    CHECK(format(0.1) == ">0.1");
+    CHECK(format(1e100) == ">1e+100");
+    CHECK(format(2.5f) == ">2.5");
+    CHECK(format('c') == ">c");
+    CHECK(format(std::string{"foo"}) == ">foo");
+    CHECK(format(std::string_view{"bar"}) == ">bar");
+}
+
+TEST_CASE("dump - writes records that load back")
+{
+    struct record_type
+    {
+        int id;
+        double value;
+        std::string name;
+        char flag;
+        point location;
+    };
+
+    std::vector<record_type> const records = {
+        {1, 0.5, "foo", 'a', {1, 2}},
+        {-2, 1e-9, "", 'b', {3, -4}},
+    };
+
+    tsv::options opts;
+    opts.column_names = {"id", "value", "name", "flag", "location"};
+
+    std::ostringstream output;
+    tsv::dump(output, records, opts);
+
+    CHECK(output.str() ==
+        "id\tvalue\tname\tflag\tlocation\n"
+        "1\t0.5\tfoo\ta\t1,2\n"
+        "-2\t1e-09\t\tb\t3,-4\n"
+    );
+
+    auto const loaded = tsv::load<record_type>(std::istringstream{output.str()});
+
+    REQUIRE(loaded.size() == 2);
+    CHECK(loaded[1].id == -2);
+    CHECK(loaded[1].value == 1e-9);
+    CHECK(loaded[1].name == "");
+    CHECK(loaded[1].location.y == -4);
+}
+
+TEST_CASE("writer - writes large output in blocks")
+{
+    struct record_type
+    {
+        std::size_t id;
+        double value;
+    };
+
+    std::ostringstream output;
+    {
+        tsv::options opts;
+        opts.delimiter = ',';
+        opts.column_names = {"id", "value"};
+        tsv::writer<record_type> writer{output, opts};
+
+        for (std::size_t i = 0; i < 200000; i++) {
+            writer.write({i, static_cast<double>(i) / 8});
+        }
+    }
+
+    tsv::options opts;
+    opts.delimiter = ',';
+    auto const loaded = tsv::load<record_type>(std::istringstream{output.str()}, opts);
+
+    REQUIRE(loaded.size() == 200000);
+    CHECK(loaded.back().id == 199999);
+    CHECK(loaded.back().value == 199999.0 / 8);
+}
+
+TEST_CASE("writer - reports errors")
+{
+    struct record_type
+    {
+        int id;
+        std::string name;
+    };
+
+    std::ostringstream output;
+
+    tsv::options opts;
+    opts.header = false;
+
+    SUBCASE("field with delimiter")
+    {
+        tsv::writer<record_type> writer{output, opts};
+        writer.write({1, "foo"});
+        CHECK_THROWS_AS(writer.write({2, "a\tb"}), tsv::format_error);
+        CHECK_THROWS_AS(writer.write({3, "a\nb"}), tsv::format_error);
+        CHECK_THROWS_AS(writer.write({4, "a\rb"}), tsv::format_error);
+        writer.flush();
+
+        CHECK(output.str() == "1\tfoo\n");
+    }
+
+    SUBCASE("number with delimiter")
+    {
+        struct number_record
+        {
+            double x;
+            int y;
+        };
+
+        opts.delimiter = '.';
+        tsv::writer<number_record> writer{output, opts};
+        CHECK_THROWS_AS(writer.write({1.5, -2}), tsv::format_error);
+        writer.write({2, -3});
+        writer.flush();
+
+        CHECK(output.str() == "2.-3\n");
+    }
+
+    SUBCASE("mismatched column names")
+    {
+        opts.header = true;
+        opts.column_names = {"id"};
+        CHECK_THROWS_AS(tsv::writer<record_type>(output, opts), std::invalid_argument);
+    }
+
+    SUBCASE("header without column names")
+    {
+        tsv::dump(output, std::vector<record_type>{{1, "foo"}});
+        CHECK(output.str() == "1\tfoo\n");
+    }
+
+    SUBCASE("failed stream")
+    {
+        tsv::writer<record_type> writer{output, opts};
+        writer.write({1, "foo"});
+        output.setstate(std::ios::failbit);
+        CHECK_THROWS_AS(writer.flush(), tsv::io_error);
+    }
+}
+
+TEST_CASE("writer - writes interned fields")
+{
+    struct country_tag;
+
+    struct record_type
+    {
+        tsv::interned<country_tag> country;
+        int count;
+    };
+
+    tsv::dictionary dictionary;
+    tsv::options opts;
+    opts.header = false;
+    opts.dictionary = &dictionary;
+
+    auto const records = tsv::load<record_type>(
+        std::istringstream{"jp\t1\nus\t2\njp\t3\n"}, opts
+    );
+
+    std::ostringstream output;
+    tsv::dump(output, records, opts);
+
+    CHECK(output.str() == "jp\t1\nus\t2\njp\t3\n");
+
+    tsv::options no_dictionary;
+    no_dictionary.header = false;
+    CHECK_THROWS_AS((tsv::writer<record_type>{output, no_dictionary}), std::invalid_argument);
+}
+
+TEST_CASE("writer - escapes special characters")
+{
+    struct record_type
+    {
+        std::string text;
+        int value;
+    };
+
+    std::vector<record_type> const records = {
+        {"foo", 1},
+        {"a\tb\\c\nd\re", 2},
+    };
+
+    tsv::options opts;
+    opts.column_names = {"text", "value"};
+    opts.escaping = tsv::escaping::backslash;
+
+    std::ostringstream output;
+    tsv::dump(output, records, opts);
+
+    CHECK(output.str() ==
+        "text\tvalue\n"
+        "foo\t1\n"
+        "a\\tb\\\\c\\nd\\re\t2\n"
+    );
+
+    auto const loaded = tsv::load<record_type>(std::istringstream{output.str()}, opts);
+
+    REQUIRE(loaded.size() == 2);
+    CHECK(loaded[1].text == records[1].text);
+    CHECK(loaded[1].value == 2);
+}